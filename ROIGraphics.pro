@@ -1,42 +1,18 @@
-QT       += core gui
-QT += xml
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-CONFIG += c++11
-
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    main.cpp \
-    simpleroi.cpp \
-    widget.cpp \
-    visioncom.cpp \
-    visionwidgets.cpp \
-
-HEADERS += \
-    simpleroi.h \
-    widget.h \
-    visioncom.h \
-    visionwidgets.h
-
-FORMS += \
-    widget.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-
-INCLUDEPATH +=D:\opencv\build-forQt\install\include
-LIBS +=D:\opencv\build-forQt\lib\libopencv_*.a
+TEMPLATE = subdirs
+
+# roicore: 不依赖GUI的ROI几何核心静态库
+# app: 交互程序ROIGraphics
+# batchrunner: 无界面批处理程序roibatch
+# bench: 性能基准
+# tests: 正确性测试(QtTest)
+SUBDIRS += \
+    roicore \
+    app \
+    batchrunner \
+    bench \
+    tests
+
+app.depends = roicore
+batchrunner.depends = roicore
+bench.depends = roicore
+tests.depends = roicore
@@ -0,0 +1,69 @@
+QT       += core gui
+QT += xml
+QT += concurrent
+
+TARGET = ROIGraphics
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++11
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    main.cpp \
+    simpleroi.cpp \
+    widget.cpp \
+    visioncom.cpp \
+    visionwidgets.cpp \
+    pixelconvert.cpp \
+    displaymapper.cpp \
+    imageitems.cpp \
+    imageloader.cpp \
+    framestream.cpp \
+    roihistogram.cpp \
+    caliper.cpp \
+    roipipeline.cpp \
+    liveworker.cpp \
+    roibatchlayer.cpp \
+    roihitindex.cpp \
+    roiundo.cpp \
+
+HEADERS += \
+    simpleroi.h \
+    widget.h \
+    visioncom.h \
+    visionwidgets.h \
+    pixelconvert.h \
+    displaymapper.h \
+    imageitems.h \
+    imageloader.h \
+    framestream.h \
+    roihistogram.h \
+    caliper.h \
+    roipipeline.h \
+    liveworker.h \
+    roibatchlayer.h \
+    roihitindex.h \
+    roiundo.h
+
+FORMS += \
+    widget.ui
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+
+include(../roicore/roicore.pri)
+include(../opencv.pri)
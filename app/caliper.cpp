@@ -0,0 +1,508 @@
+#include "caliper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <QRunnable>
+#include <QThread>
+#include <opencv2/imgproc/imgproc.hpp>
+
+//class CaliperEngine  卡尺测量引擎
+
+CaliperEngine::CaliperEngine() :m_length(0), m_lines(0), m_gridValid(false),
+    m_gridCols(0), m_gridRows(0), m_offsetStep(0), m_offsetElem(-1)
+{
+
+}
+
+CaliperEngine::~CaliperEngine()
+{
+
+}
+
+/**
+ * @brief CaliperEngine::setGeometry  设置卡尺四边形，顶点不变时保留采样网格
+ * @param vertexes  左上、右上、右下、左下四个顶点(图像坐标)
+ */
+void CaliperEngine::setGeometry(const std::vector<QPointF> &vertexes)
+{
+    if(vertexes.size() <4)  return;
+    bool same =true;
+    for(int i =0; i <4; i++){
+        if(m_quad[i] !=vertexes[i]){
+            m_quad[i] =vertexes[i];
+            same =false;
+        }
+    }
+    if(!same)  m_gridValid =false;
+}
+
+/**
+ * @brief CaliperEngine::setGeometry  同上，取CaliperGeometry的四个顶点
+ * @param geometry
+ */
+void CaliperEngine::setGeometry(const CaliperGeometry &geometry)
+{
+    bool same =true;
+    for(int i =0; i <4; i++){
+        if(m_quad[i] !=geometry.vertexes[i]){
+            m_quad[i] =geometry.vertexes[i];
+            same =false;
+        }
+    }
+    if(!same)  m_gridValid =false;
+}
+
+void CaliperEngine::setParams(const CaliperParams &params)
+{
+    if(params.projectionLines !=m_params.projectionLines)  m_gridValid =false;
+    if(params.sigma !=m_params.sigma)  m_kernel.clear();
+    m_params =params;
+}
+
+/**
+ * @brief CaliperEngine::measure
+ * 测量：必要时重建网格/偏移表，采样投影曲线，平滑求导，检测边缘并配对
+ * @param image  CV_8UC1或CV_16UC1，不小于2x2
+ * @param result  输出，其中的容器被清空后复用
+ * @return
+ */
+bool CaliperEngine::measure(const cv::Mat &image, CaliperResult &result)
+{
+    result.edges.clear();
+    result.pairs.clear();
+    if(image.cols <2 || image.rows <2 || image.channels() !=1)  return false;
+    if(image.depth() !=CV_8U && image.depth() !=CV_16U)  return false;
+
+    if(!m_gridValid || m_gridCols !=image.cols || m_gridRows !=image.rows)
+        buildGrid(image.cols, image.rows);
+    if(m_length <3)  return false;
+    if(m_offsetStep !=image.step1() || m_offsetElem !=image.type() || m_offset.size() !=m_x0.size())
+        buildOffsets(image);
+
+    if(image.depth() ==CV_8U)
+        sampleProfile<uchar>(image);
+    else
+        sampleProfile<ushort>(image);
+    smoothProfile();
+    detectEdges(result);
+    pairEdges(result);
+    return true;
+}
+
+/**
+ * @brief CaliperEngine::buildGrid
+ * 采样点位于每个采样格的中心，像素(c, r)的中心为(c +0.5, r +0.5)；
+ * 按投影线优先存放，使同一条线上的累加连续访问曲线数组
+ * @param cols
+ * @param rows
+ */
+void CaliperEngine::buildGrid(int cols, int rows)
+{
+    QPointF du =m_quad[1] -m_quad[0];
+    QPointF dv =m_quad[3] -m_quad[0];
+    double len =std::hypot(du.x(), du.y());
+    double height =std::hypot(dv.x(), dv.y());
+    m_length =std::max(0, int(std::lround(len)));
+    m_lines =m_params.projectionLines >0 ? m_params.projectionLines : std::max(1, int(std::lround(height)));
+    m_gridCols =cols;
+    m_gridRows =rows;
+    m_gridValid =true;
+    m_offset.clear();
+    if(m_length <3)  return;
+
+    m_su =du /m_length;
+    m_sv =dv /m_lines;
+    size_t n =size_t(m_length) *m_lines;
+    m_x0.resize(n);
+    m_y0.resize(n);
+    m_w00.resize(n);
+    m_w01.resize(n);
+    m_w10.resize(n);
+    m_w11.resize(n);
+    const double maxX =cols -1.001, maxY =rows -1.001;
+    size_t k =0;
+    for(int j =0; j <m_lines; ++j){
+        QPointF lineStart =m_quad[0] +m_sv *(j +0.5) -QPointF(0.5, 0.5);
+        for(int i =0; i <m_length; ++i, ++k){
+            QPointF p =lineStart +m_su *(i +0.5);
+            double x =std::min(std::max(p.x(), 0.0), maxX);
+            double y =std::min(std::max(p.y(), 0.0), maxY);
+            int x0 =int(x), y0 =int(y);
+            float fx =float(x -x0), fy =float(y -y0);
+            m_x0[k] =x0;
+            m_y0[k] =y0;
+            m_w00[k] =(1 -fx) *(1 -fy);
+            m_w01[k] =fx *(1 -fy);
+            m_w10[k] =(1 -fx) *fy;
+            m_w11[k] =fx *fy;
+        }
+    }
+    m_profile.resize(m_length);
+    m_smooth.resize(m_length);
+    m_deriv.resize(m_length);
+}
+
+/**
+ * @brief CaliperEngine::buildOffsets  由网格坐标计算元素偏移，图像步长变化时重建
+ * @param image
+ */
+void CaliperEngine::buildOffsets(const cv::Mat &image)
+{
+    m_offsetStep =image.step1();
+    m_offsetElem =image.type();
+    m_offset.resize(m_x0.size());
+    for(size_t k =0; k <m_x0.size(); ++k)
+        m_offset[k] =int(m_y0[k] *m_offsetStep) +m_x0[k];
+}
+
+/**
+ * @brief CaliperEngine::sampleProfile
+ * 双线性插值采样并沿投影方向求平均，内层循环只有顺序读取的权重和偏移，便于编译器向量化
+ * @param image
+ */
+template <typename T>
+void CaliperEngine::sampleProfile(const cv::Mat &image)
+{
+    const T *base =image.ptr<T>(0);
+    const size_t stride =m_offsetStep;
+    const int *offset =m_offset.data();
+    const float *w00 =m_w00.data(), *w01 =m_w01.data(), *w10 =m_w10.data(), *w11 =m_w11.data();
+    float *prof =m_profile.data();
+    std::fill(m_profile.begin(), m_profile.end(), 0.f);
+    size_t k =0;
+    for(int j =0; j <m_lines; ++j){
+        for(int i =0; i <m_length; ++i, ++k){
+            const T *p =base +offset[k];
+            prof[i] +=w00[k] *p[0] +w01[k] *p[1] +w10[k] *p[stride] +w11[k] *p[stride +1];
+        }
+    }
+    const float inv =1.f /m_lines;
+    for(int i =0; i <m_length; ++i)
+        prof[i] *=inv;
+}
+
+/**
+ * @brief CaliperEngine::smoothProfile  高斯平滑后用中心差分求导
+ */
+void CaliperEngine::smoothProfile()
+{
+    int radius =0;
+    if(m_params.sigma >0){
+        radius =std::min(int(std::ceil(3 *m_params.sigma)), m_length /2);
+        if(int(m_kernel.size()) !=2 *radius +1){
+            m_kernel.resize(2 *radius +1);
+            float sum =0;
+            for(int t =-radius; t <=radius; ++t){
+                m_kernel[t +radius] =float(std::exp(-0.5 *t *t /(m_params.sigma *m_params.sigma)));
+                sum +=m_kernel[t +radius];
+            }
+            for(float &v :m_kernel)  v /=sum;
+        }
+    }
+    if(radius ==0){
+        std::copy(m_profile.begin(), m_profile.end(), m_smooth.begin());
+    }
+    else{
+        for(int i =0; i <m_length; ++i){
+            float acc =0;
+            for(int t =-radius; t <=radius; ++t){
+                int idx =std::min(std::max(i +t, 0), m_length -1);
+                acc +=m_kernel[t +radius] *m_profile[idx];
+            }
+            m_smooth[i] =acc;
+        }
+    }
+    m_deriv[0] =m_deriv[m_length -1] =0;
+    for(int i =1; i <m_length -1; ++i)
+        m_deriv[i] =0.5f *(m_smooth[i +1] -m_smooth[i -1]);
+}
+
+/**
+ * @brief CaliperEngine::detectEdges
+ * 导数绝对值的局部极大且超过阈值处为边缘，用抛物线拟合求亚像素位置
+ * @param result
+ */
+void CaliperEngine::detectEdges(CaliperResult &result) const
+{
+    const double stepLen =std::hypot(m_su.x(), m_su.y());
+    const QPointF midLine =m_quad[0] +m_sv *(m_lines *0.5);
+    for(int i =1; i <m_length -1; ++i){
+        float c =std::abs(m_deriv[i]);
+        if(c <m_params.threshold)  continue;
+        float l =std::abs(m_deriv[i -1]), r =std::abs(m_deriv[i +1]);
+        if(c <l || c <=r)  continue;
+        float denom =l -2 *c +r;
+        double offset =denom !=0 ? 0.5 *(l -r) /denom : 0;
+        offset =std::min(std::max(offset, -0.5), 0.5);
+        double t =i +0.5 +offset;
+        CaliperEdge edge;
+        edge.point =midLine +m_su *t;
+        edge.position =t *stepLen;
+        edge.strength =c;
+        edge.polarity =m_deriv[i] >0 ? 1 : -1;
+        result.edges.push_back(edge);
+    }
+}
+
+/**
+ * @brief CaliperEngine::pairEdges
+ * 每条符合极性要求的边缘与其后第一条极性相反的边缘配对，
+ * 评分为两边缘中较弱者的相对强度，设置期望宽度时乘以宽度偏差的惩罚
+ * @param result
+ */
+void CaliperEngine::pairEdges(CaliperResult &result) const
+{
+    const std::vector<CaliperEdge> &edges =result.edges;
+    double maxStrength =0;
+    for(const CaliperEdge &e :edges)
+        maxStrength =std::max(maxStrength, e.strength);
+    if(maxStrength <=0)  return;
+    for(size_t a =0; a <edges.size(); ++a){
+        if(m_params.polarity !=0 && edges[a].polarity !=m_params.polarity)  continue;
+        for(size_t b =a +1; b <edges.size(); ++b){
+            if(edges[b].polarity !=-edges[a].polarity)  continue;
+            CaliperEdgePair pair;
+            pair.first =edges[a];
+            pair.second =edges[b];
+            pair.width =edges[b].position -edges[a].position;
+            pair.score =std::min(edges[a].strength, edges[b].strength) /maxStrength;
+            if(m_params.expectedWidth >0){
+                double dev =(pair.width -m_params.expectedWidth) /m_params.expectedWidth;
+                pair.score /=1 +dev *dev;
+            }
+            result.pairs.push_back(pair);
+            break;
+        }
+    }
+    std::sort(result.pairs.begin(), result.pairs.end(), [](const CaliperEdgePair &x, const CaliperEdgePair &y){
+        return x.score >y.score;
+    });
+    if(m_params.maxPairs >0 && int(result.pairs.size()) >m_params.maxPairs)
+        result.pairs.resize(m_params.maxPairs);
+}
+
+
+
+//class PatchExtractor  卡尺区域校正提取
+
+PatchExtractor::PatchExtractor() :m_mapValid(false)
+{
+
+}
+
+PatchExtractor::~PatchExtractor()
+{
+
+}
+
+/**
+ * @brief PatchExtractor::setGeometry  几何不变时保留重映射表
+ * @param geometry
+ */
+void PatchExtractor::setGeometry(const CaliperGeometry &geometry)
+{
+    bool same =geometry.angle ==m_geometry.angle && geometry.shearAngle ==m_geometry.shearAngle;
+    for(int i =0; i <4 && same; i++)
+        same =geometry.vertexes[i] ==m_geometry.vertexes[i];
+    if(same)  return;
+    m_geometry =geometry;
+    m_mapValid =false;
+}
+
+/**
+ * @brief PatchExtractor::extract
+ * 双线性插值提取，四边形超出图像的部分填0
+ * @param image  任意类型
+ * @param patch  输出，尺寸为四边形上边长x左边长，尺寸和类型不变时不重新分配
+ * @return
+ */
+bool PatchExtractor::extract(const cv::Mat &image, cv::Mat &patch)
+{
+    if(image.empty())  return false;
+    if(!m_mapValid)  buildMaps();
+    if(m_size.area() <=0)  return false;
+    cv::remap(image, patch, m_mapXY, m_mapFrac, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    return true;
+}
+
+/**
+ * @brief PatchExtractor::buildMaps
+ * 目标像素(u, v)的中心对应源坐标 origin +(u +0.5)*axisU +(v +0.5)*axisV -(0.5, 0.5)，
+ * 生成浮点映射后转换为remap最快的CV_16SC2 +CV_16UC1定点格式
+ */
+void PatchExtractor::buildMaps()
+{
+    const QPointF *v =m_geometry.vertexes;
+    QPointF top =v[1] -v[0], left =v[3] -v[0];
+    int width =int(std::lround(std::hypot(top.x(), top.y())));
+    int height =int(std::lround(std::hypot(left.x(), left.y())));
+    m_size =cv::Size(width, height);
+    m_mapValid =true;
+    if(width <=0 || height <=0)  return;
+
+    double a =m_geometry.angle, av =m_geometry.angle +m_geometry.shearAngle;
+    double ux =std::cos(a), uy =std::sin(a);
+    double vx =-std::sin(av), vy =std::cos(av);
+    double ox =v[0].x() -0.5 +0.5 *(ux +vx), oy =v[0].y() -0.5 +0.5 *(uy +vy);
+    cv::Mat mapX(height, width, CV_32FC1), mapY(height, width, CV_32FC1);
+    for(int r =0; r <height; ++r){
+        float *px =mapX.ptr<float>(r), *py =mapY.ptr<float>(r);
+        double rx =ox +r *vx, ry =oy +r *vy;
+        for(int c =0; c <width; ++c){
+            px[c] =float(rx +c *ux);
+            py[c] =float(ry +c *uy);
+        }
+    }
+    cv::convertMaps(mapX, mapY, m_mapXY, m_mapFrac, CV_16SC2);
+}
+
+
+//class CaliperBatch  批量卡尺测量
+
+/**
+ * @brief The CaliperBatch::Worker class
+ * 任务区间[begin, end)打包在一个64位原子量中：本线程从头部取，其他线程从尾部窃取
+ */
+class CaliperBatch::Worker :public QRunnable
+{
+public:
+    Worker(std::vector<Worker*> *workers, int index) :m_workers(workers), m_index(index),
+        m_image(nullptr), m_geometries(nullptr), m_engines(nullptr), m_results(nullptr)
+    {
+        setAutoDelete(false);
+    }
+
+    void prepare(const cv::Mat *image, const std::vector<CaliperGeometry> *geometries,
+                 std::vector<CaliperEngine> *engines, std::vector<CaliperResult> *results, int begin, int end)
+    {
+        m_image =image;
+        m_geometries =geometries;
+        m_engines =engines;
+        m_results =results;
+        m_range.store(pack(begin, end));
+    }
+
+    void run() override
+    {
+        int begin, end;
+        for(;;){
+            int index;
+            while(popFront(index))
+                measureOne(index);
+            if(!stealFromOthers(begin, end))  break;
+            m_range.store(pack(begin, end));
+        }
+    }
+private:
+    std::vector<Worker*> *m_workers;
+    int m_index;
+    const cv::Mat *m_image;
+    const std::vector<CaliperGeometry> *m_geometries;
+    std::vector<CaliperEngine> *m_engines;
+    std::vector<CaliperResult> *m_results;
+    std::atomic<quint64> m_range;
+
+    static quint64 pack(int begin, int end)  { return (quint64(quint32(end)) <<32) |quint32(begin);}
+    static int rangeBegin(quint64 v)  { return int(quint32(v));}
+    static int rangeEnd(quint64 v)  { return int(quint32(v >>32));}
+
+    void measureOne(int index)
+    {
+        CaliperEngine &engine =(*m_engines)[index];
+        engine.setGeometry((*m_geometries)[index]);
+        engine.measure(*m_image, (*m_results)[index]);
+    }
+
+    bool popFront(int &index)
+    {
+        quint64 old =m_range.load();
+        for(;;){
+            int b =rangeBegin(old), e =rangeEnd(old);
+            if(b >=e)  return false;
+            if(m_range.compare_exchange_weak(old, pack(b +1, e))){
+                index =b;
+                return true;
+            }
+        }
+    }
+
+    bool stealHalf(int &begin, int &end)
+    {
+        quint64 old =m_range.load();
+        for(;;){
+            int b =rangeBegin(old), e =rangeEnd(old);
+            if(e -b <2)  return false;
+            int mid =e -(e -b) /2;
+            if(m_range.compare_exchange_weak(old, pack(b, mid))){
+                begin =mid;
+                end =e;
+                return true;
+            }
+        }
+    }
+
+    bool stealFromOthers(int &begin, int &end)
+    {
+        int n =int(m_workers->size());
+        for(int k =1; k <n; ++k){
+            if((*m_workers)[(m_index +k) %n]->stealHalf(begin, end))
+                return true;
+        }
+        return false;
+    }
+};
+
+CaliperBatch::CaliperBatch(int threadCount)
+{
+    if(threadCount <=0)  threadCount =QThread::idealThreadCount();
+    threadCount =qMax(1, threadCount);
+    m_pool.setMaxThreadCount(threadCount);
+    m_pool.setExpiryTimeout(-1);
+    for(int i =0; i <threadCount; ++i)
+        m_workers.push_back(new Worker(&m_workers, i));
+}
+
+CaliperBatch::~CaliperBatch()
+{
+    m_pool.waitForDone();
+    for(Worker *worker :m_workers)
+        delete worker;
+}
+
+void CaliperBatch::setParams(const CaliperParams &params)
+{
+    m_params =params;
+    for(CaliperEngine &engine :m_engines)
+        engine.setParams(params);
+}
+
+/**
+ * @brief CaliperBatch::measure
+ * 阻塞直到全部测量完成。卡尺数量增加时为新下标创建引擎，已有下标的网格保留
+ * @param image  CV_8UC1或CV_16UC1
+ * @param geometries
+ * @param results  调整为与geometries同样大小，results[i]对应geometries[i]
+ */
+void CaliperBatch::measure(const cv::Mat &image, const std::vector<CaliperGeometry> &geometries,
+                           std::vector<CaliperResult> &results)
+{
+    int n =int(geometries.size());
+    results.resize(n);
+    if(n ==0)  return;
+    if(int(m_engines.size()) <n){
+        size_t old =m_engines.size();
+        m_engines.resize(n);
+        for(size_t i =old; i <m_engines.size(); ++i)
+            m_engines[i].setParams(m_params);
+    }
+    int workers =qMin(int(m_workers.size()), n);
+    for(int i =0; i <int(m_workers.size()); ++i){
+        int begin =i <workers ? qint64(n) *i /workers : n;
+        int end =i <workers ? qint64(n) *(i +1) /workers : n;
+        m_workers[i]->prepare(&image, &geometries, &m_engines, &results, begin, end);
+    }
+    for(int i =0; i <workers; ++i)
+        m_pool.start(m_workers[i]);
+    m_pool.waitForDone();
+}
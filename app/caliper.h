@@ -0,0 +1,159 @@
+#ifndef CALIPER_H
+#define CALIPER_H
+
+/**
+卡尺测量：沿旋转/倾斜四边形采样一维投影曲线，求导检测边缘并配对
+**/
+
+#include <QPointF>
+#include <QThreadPool>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief The CaliperParams struct  卡尺测量参数
+ */
+struct CaliperParams
+{
+    int projectionLines =0;     //投影线数，0表示按四边形高度每像素一条
+    double sigma =1.0;          //高斯平滑系数，<=0不平滑
+    double threshold =10;       //最小边缘强度(灰度/像素)
+    int polarity =0;            //边缘对第一条边的极性：1暗到亮，-1亮到暗，0任意
+    double expectedWidth =0;    //期望宽度(像素)，>0时参与评分
+    int maxPairs =1;            //最多返回的边缘对数
+};
+
+/**
+ * @brief The CaliperEdge struct  单条边缘
+ */
+struct CaliperEdge
+{
+    QPointF point;      //图像坐标
+    double position;    //沿搜索方向距起始边的距离(像素)
+    double strength;    //导数绝对值
+    int polarity;       //1暗到亮，-1亮到暗
+};
+
+/**
+ * @brief The CaliperEdgePair struct  边缘对，宽度为两边缘沿搜索方向的距离
+ */
+struct CaliperEdgePair
+{
+    CaliperEdge first;
+    CaliperEdge second;
+    double width;
+    double score;
+};
+
+/**
+ * @brief The CaliperResult struct  测量结果，容器在重复测量时复用
+ */
+struct CaliperResult
+{
+    std::vector<CaliperEdge> edges;
+    std::vector<CaliperEdgePair> pairs;
+};
+
+/**
+ * @brief The CaliperGeometry struct  卡尺几何，批量测量的输入
+ */
+struct CaliperGeometry
+{
+    QPointF vertexes[4];    //左上、右上、右下、左下(图像坐标)
+    double angle =0;        //旋转角(弧度)
+    double shearAngle =0;   //倾斜角(弧度)
+};
+
+/**
+ * @brief The CaliperEngine class
+ * 卡尺测量引擎。四边形顶点顺序与CaliperTool::vertexes()一致：左上、右上、右下、左下，
+ * 搜索方向为0->1，投影方向为0->3。采样网格(整数坐标和双线性权重，按结构数组存放)只在
+ * 四边形变化时重建，测量时只做一次顺序的收集-加权累加，之后在一维曲线上求导检测边缘
+ */
+class CaliperEngine
+{
+public:
+    CaliperEngine();
+    ~CaliperEngine();
+
+    void setGeometry(const std::vector<QPointF> &vertexes);
+    void setGeometry(const CaliperGeometry &geometry);
+    void setParams(const CaliperParams &params);
+    const CaliperParams& params() const  { return m_params;}
+    bool measure(const cv::Mat &image, CaliperResult &result);
+    const std::vector<float>& profile() const  { return m_profile;}
+private:
+    QPointF m_quad[4];
+    CaliperParams m_params;
+    int m_length;
+    int m_lines;
+    QPointF m_su, m_sv;
+    bool m_gridValid;
+    int m_gridCols, m_gridRows;
+    std::vector<int> m_x0, m_y0;
+    std::vector<float> m_w00, m_w01, m_w10, m_w11;
+    std::vector<int> m_offset;
+    size_t m_offsetStep;
+    int m_offsetElem;
+    std::vector<float> m_profile, m_smooth, m_deriv, m_kernel;
+
+    void buildGrid(int cols, int rows);
+    void buildOffsets(const cv::Mat &image);
+    template <typename T> void sampleProfile(const cv::Mat &image);
+    void smoothProfile();
+    void detectEdges(CaliperResult &result) const;
+    void pairEdges(CaliperResult &result) const;
+};
+
+
+/**
+ * @brief The PatchExtractor class
+ * 将卡尺四边形下的像素校正为矩形图像块：u轴为旋转角方向，v轴为旋转角+倾斜角的法向，
+ * 原点为左上顶点。重映射表(定点格式)在几何或图像尺寸变化时才重建，
+ * 重复提取只做一次remap，输出缓冲复用，只访问四边形覆盖到的源像素
+ */
+class PatchExtractor
+{
+public:
+    PatchExtractor();
+    ~PatchExtractor();
+
+    void setGeometry(const CaliperGeometry &geometry);
+    bool extract(const cv::Mat &image, cv::Mat &patch);
+    cv::Size patchSize() const  { return m_size;}
+private:
+    CaliperGeometry m_geometry;
+    bool m_mapValid;
+    cv::Size m_size;
+    cv::Mat m_mapXY;
+    cv::Mat m_mapFrac;
+
+    void buildMaps();
+};
+
+/**
+ * @brief The CaliperBatch class
+ * 批量卡尺测量：同一幅图像上的大量卡尺在私有线程池中并行测量。
+ * 任务按线程均分为连续区间，线程做完自己的区间后从其他线程区间的尾部窃取一半。
+ * 每个卡尺(按下标)对应一个CaliperEngine，采样网格在多次调用间保留，同一下标的几何和图像尺寸不变时
+ * 不再重建；一次调用中每个下标只由一个线程测量，引擎无需加锁。结果与输入顺序一致
+ */
+class CaliperBatch
+{
+public:
+    CaliperBatch(int threadCount =0);
+    ~CaliperBatch();
+
+    void setParams(const CaliperParams &params);
+    int threadCount() const  { return int(m_workers.size());}
+    void measure(const cv::Mat &image, const std::vector<CaliperGeometry> &geometries,
+                 std::vector<CaliperResult> &results);
+private:
+    class Worker;
+    QThreadPool m_pool;
+    std::vector<Worker*> m_workers;
+    std::vector<CaliperEngine> m_engines;
+    CaliperParams m_params;
+};
+
+#endif // CALIPER_H
@@ -0,0 +1,257 @@
+#include "displaymapper.h"
+#include "visioncom.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#define DISPLAY_HIST_BINS 4096  //直方图箱数
+#define DISPLAY_ROWS_PER_STRIPE 64  //并行映射时每块的行数
+
+DisplayMapper::DisplayMapper() :m_min(0), m_max(0), m_low(0), m_high(255),
+    m_colormap(-1), m_pixelsDirty(true), m_colorsDirty(true), m_valueLutDirty(true)
+{
+
+}
+
+DisplayMapper::~DisplayMapper()
+{
+
+}
+
+/**
+ * @brief DisplayMapper::setSource
+ * 设置源图像(浅拷贝)，统计最小最大值和直方图，并默认按最小最大值拉伸
+ * @param src  任意位深，1/3/4通道
+ */
+void DisplayMapper::setSource(const cv::Mat &src)
+{
+    m_source =src;
+    m_pixelsDirty =true;
+    m_hist.assign(DISPLAY_HIST_BINS, 0.f);
+    m_min =m_max =0;
+    if(m_source.empty())  return;
+
+    cv::Mat plane =m_source.channels() ==1 ? m_source : m_source.reshape(1);
+    cv::minMaxLoc(plane, &m_min, &m_max);
+    if(m_max >m_min){
+        cv::Mat planeF;
+        if(plane.depth() ==CV_8U || plane.depth() ==CV_16U || plane.depth() ==CV_32F)
+            planeF =plane;
+        else
+            plane.convertTo(planeF, CV_32F);
+        int channels[] ={0};
+        int histSize[] ={DISPLAY_HIST_BINS};
+        float range[] ={float(m_min), float(m_max) +float(m_max -m_min) /DISPLAY_HIST_BINS};
+        const float *ranges[] ={range};
+        cv::Mat hist;
+        cv::calcHist(&planeF, 1, channels, cv::Mat(), hist, 1, histSize, ranges);
+        m_hist.assign(hist.ptr<float>(), hist.ptr<float>() +DISPLAY_HIST_BINS);
+    }
+    setRange(m_min, m_max);
+}
+
+/**
+ * @brief DisplayMapper::setWindow  窗宽窗位
+ * @param level  窗位(窗口中心)
+ * @param width  窗宽
+ */
+void DisplayMapper::setWindow(double level, double width)
+{
+    setRange(level -width /2, level +width /2);
+}
+
+/**
+ * @brief DisplayMapper::setRange  [low, high]线性映射到[0, 255]，范围外饱和
+ * @param low
+ * @param high
+ */
+void DisplayMapper::setRange(double low, double high)
+{
+    if(high <=low)  high =low +1e-6;
+    if(low ==m_low && high ==m_high)  return;
+    m_low =low;
+    m_high =high;
+    m_pixelsDirty =true;
+    m_valueLutDirty =true;
+}
+
+/**
+ * @brief DisplayMapper::stretchMinMax
+ * 使用缓存的直方图按百分位截断后拉伸，不需要重新扫描源图像
+ * @param lowPercent  低端截断比例(%)
+ * @param highPercent  高端截断比例(%)
+ */
+void DisplayMapper::stretchMinMax(double lowPercent, double highPercent)
+{
+    double total =0;
+    for(float v :m_hist)  total +=v;
+    if(total <=0){
+        setRange(m_min, m_max);
+        return;
+    }
+    double lowCount =total *lowPercent /100, highCount =total *highPercent /100;
+    int lowBin =0, highBin =DISPLAY_HIST_BINS -1;
+    double acc =0;
+    while(lowBin <highBin && acc +m_hist[lowBin] <=lowCount)
+        acc +=m_hist[lowBin++];
+    acc =0;
+    while(highBin >lowBin && acc +m_hist[highBin] <=highCount)
+        acc +=m_hist[highBin--];
+    setRange(histogramBinValue(lowBin), histogramBinValue(highBin +1));
+}
+
+/**
+ * @brief DisplayMapper::setColorMap  伪彩色，只修改调色板
+ * @param colormap  cv::ColormapTypes，-1为灰度
+ */
+void DisplayMapper::setColorMap(int colormap)
+{
+    if(colormap ==m_colormap)  return;
+    m_colormap =colormap;
+    m_colorsDirty =true;
+}
+
+/**
+ * @brief DisplayMapper::setLut  8位查找表(如伽马校正)，与伪彩色组合后写入调色板
+ * @param lut  256项，为空则取消
+ */
+void DisplayMapper::setLut(const std::vector<uchar> &lut)
+{
+    m_lut =lut.size() ==256 ? lut : std::vector<uchar>();
+    m_colorsDirty =true;
+}
+
+/**
+ * @brief DisplayMapper::histogramBinValue  直方图第bin箱的起始灰度值
+ * @param bin
+ * @return
+ */
+double DisplayMapper::histogramBinValue(int bin) const
+{
+    return m_min +(m_max -m_min) *bin /DISPLAY_HIST_BINS;
+}
+
+/**
+ * @brief DisplayMapper::image
+ * 单通道返回带调色板的Indexed8，多通道返回BGR/BGRA的8位图像；返回的QImage与内部缓冲共享数据
+ * @return
+ */
+QImage DisplayMapper::image()
+{
+    if(m_source.empty())  return QImage();
+    if(m_pixelsDirty)  mapPixels();
+    if(m_source.channels() !=1)  return cvMat2QImageShared(m_display);
+    if(m_colorsDirty)  buildColorTable();
+    return cvMat2QImageShared(m_display, m_colors);
+}
+
+/**
+ * @brief DisplayMapper::map
+ * 按当前窗口和调色板映射一块与源同类型的图像(如源图像的子区域或其金字塔层的块)，
+ * 返回的QImage持有独立的缓冲，格式与image()相同
+ * @param patch
+ * @return
+ */
+QImage DisplayMapper::map(const cv::Mat &patch)
+{
+    if(patch.empty())  return QImage();
+    prepareValueLut(patch.depth());
+    cv::Mat out(patch.size(), CV_MAKETYPE(CV_8U, patch.channels()));
+    mapTo(patch, out);
+    if(patch.channels() !=1)  return cvMat2QImageShared(out);
+    if(m_colorsDirty)  buildColorTable();
+    return cvMat2QImageShared(out, m_colors);
+}
+
+/**
+ * @brief DisplayMapper::mapPixels
+ * 一次线性映射 dst =saturate(src *alpha +beta)，按行分块并行；
+ * 缓冲仍被之前返回的QImage引用时重新分配，避免改写已显示的图像
+ */
+void DisplayMapper::mapPixels()
+{
+    if(m_display.u && m_display.u->refcount >1)
+        m_display.release();
+    m_display.create(m_source.size(), CV_MAKETYPE(CV_8U, m_source.channels()));
+    prepareValueLut(m_source.depth());
+    const cv::Mat &src =m_source;
+    cv::Mat &dst =m_display;
+    int stripes =(src.rows +DISPLAY_ROWS_PER_STRIPE -1) /DISPLAY_ROWS_PER_STRIPE;
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range &range){
+        int r0 =range.start *DISPLAY_ROWS_PER_STRIPE;
+        int r1 =std::min(src.rows, range.end *DISPLAY_ROWS_PER_STRIPE);
+        cv::Mat out =dst.rowRange(r0, r1);
+        mapTo(src.rowRange(r0, r1), out);
+    });
+    m_pixelsDirty =false;
+}
+
+/**
+ * @brief DisplayMapper::prepareValueLut
+ * 8/16位时按窗口建立查找表，取值与convertTo(CV_8U, alpha, beta)的舍入和饱和一致；窗口不变时复用
+ * @param depth  待映射图像的位深
+ */
+void DisplayMapper::prepareValueLut(int depth)
+{
+    size_t size =depth ==CV_8U ? 256 : depth ==CV_16U ? 65536 : 0;
+    if(size ==0 || (!m_valueLutDirty && m_valueLut.size() ==size))  return;
+    double alpha =255.0 /(m_high -m_low);
+    double beta =-m_low *alpha;
+    m_valueLut.resize(size);
+    for(size_t v =0; v <size; ++v)
+        m_valueLut[v] =cv::saturate_cast<uchar>(v *alpha +beta);
+    m_valueLutDirty =false;
+}
+
+/**
+ * @brief DisplayMapper::mapTo  8/16位查表，其他位深线性映射；dst已分配为同尺寸的8位图像
+ * @param src
+ * @param dst
+ */
+void DisplayMapper::mapTo(const cv::Mat &src, cv::Mat &dst) const
+{
+    size_t lutSize =src.depth() ==CV_8U ? 256 : src.depth() ==CV_16U ? 65536 : 0;
+    if(lutSize ==0 || m_valueLut.size() !=lutSize){
+        double alpha =255.0 /(m_high -m_low);
+        src.convertTo(dst, CV_8U, alpha, -m_low *alpha);
+        return;
+    }
+    const uchar *lut =m_valueLut.data();
+    const int n =src.cols *src.channels();
+    for(int r =0; r <src.rows; ++r){
+        uchar *d =dst.ptr<uchar>(r);
+        if(src.depth() ==CV_8U){
+            const uchar *p =src.ptr<uchar>(r);
+            for(int i =0; i <n; ++i)  d[i] =lut[p[i]];
+        }
+        else{
+            const ushort *p =src.ptr<ushort>(r);
+            for(int i =0; i <n; ++i)  d[i] =lut[p[i]];
+        }
+    }
+}
+
+/**
+ * @brief DisplayMapper::buildColorTable  调色板 =colormap(lut(i))
+ */
+void DisplayMapper::buildColorTable()
+{
+    cv::Mat ramp(1, 256, CV_8UC1);
+    for(int i =0; i <256; i++)
+        ramp.at<uchar>(i) =m_lut.empty() ? uchar(i) : m_lut[i];
+    m_colors.resize(256);
+    if(m_colormap <0){
+        for(int i =0; i <256; i++){
+            int g =ramp.at<uchar>(i);
+            m_colors[i] =qRgb(g, g, g);
+        }
+    }
+    else{
+        cv::Mat colored;
+        cv::applyColorMap(ramp, colored, m_colormap);
+        for(int i =0; i <256; i++){
+            cv::Vec3b c =colored.at<cv::Vec3b>(i);
+            m_colors[i] =qRgb(c[2], c[1], c[0]);
+        }
+    }
+    m_colorsDirty =false;
+}
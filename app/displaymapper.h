@@ -0,0 +1,62 @@
+#ifndef DISPLAYMAPPER_H
+#define DISPLAYMAPPER_H
+
+#include <opencv2/core/core.hpp>
+#include <QImage>
+#include <QVector>
+
+/**
+ * @brief The DisplayMapper class
+ * 将16位、浮点等高位深图像映射为8位显示图像，支持窗宽窗位/最小最大值拉伸、LUT和伪彩色。
+ * setSource时统计一次最小最大值和直方图并缓存。8位和16位源按窗口建立值->显示值查找表(256/65536项)，
+ * 调整窗口只重建查找表，映射每像素一次查表；其他位深做一次线性映射。调整LUT或伪彩色只替换调色板。
+ * 显示端可只对可见的块调用map()，窗口变化时不必重映射整幅图像
+ */
+class DisplayMapper
+{
+public:
+    DisplayMapper();
+    ~DisplayMapper();
+
+    void setSource(const cv::Mat &src);
+    const cv::Mat& source() const  { return m_source;}
+
+    void setWindow(double level, double width);
+    void setRange(double low, double high);
+    void stretchMinMax(double lowPercent =0, double highPercent =0);
+    double windowLow() const  { return m_low;}
+    double windowHigh() const  { return m_high;}
+
+    void setColorMap(int colormap);
+    void setLut(const std::vector<uchar> &lut);
+
+    double minValue() const  { return m_min;}
+    double maxValue() const  { return m_max;}
+    const std::vector<float>& histogram() const  { return m_hist;}
+    double histogramBinValue(int bin) const;
+
+    QImage image();
+    QImage map(const cv::Mat &patch);
+private:
+    cv::Mat m_source;
+    cv::Mat m_display;
+    double m_min;
+    double m_max;
+    double m_low;
+    double m_high;
+    std::vector<float> m_hist;
+    int m_colormap;
+    std::vector<uchar> m_lut;
+    QVector<QRgb> m_colors;
+    bool m_pixelsDirty;
+    bool m_colorsDirty;
+    std::vector<uchar> m_valueLut;  //8/16位源的值->显示值
+    bool m_valueLutDirty;
+
+    void mapPixels();
+    void prepareValueLut(int depth);
+    void mapTo(const cv::Mat &src, cv::Mat &dst) const;
+    void buildColorTable();
+};
+
+#endif // DISPLAYMAPPER_H
@@ -0,0 +1,185 @@
+#include "framestream.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/videoio/videoio.hpp>
+
+//class FrameRing  三缓冲帧环
+
+FrameRing::FrameRing() :m_write(0), m_read(1), m_pending(2)
+{
+
+}
+
+FrameRing::~FrameRing()
+{
+
+}
+
+/**
+ * @brief FrameRing::publish  生产者提交writeBuffer()，上一帧未被取走则计为丢帧
+ */
+void FrameRing::publish()
+{
+    int old =m_pending.fetchAndStoreOrdered(m_write |RING_FRESH);
+    m_write =old &RING_INDEX_MASK;
+    m_received.fetchAndAddRelaxed(1);
+    if(old &RING_FRESH)
+        m_dropped.fetchAndAddRelaxed(1);
+    if(m_notifier)  m_notifier();
+}
+
+/**
+ * @brief FrameRing::acquire  消费者取最新一帧到readBuffer()
+ * @return  没有新帧时返回false
+ */
+bool FrameRing::acquire()
+{
+    if(!(m_pending.loadAcquire() &RING_FRESH))  return false;
+    int old =m_pending.fetchAndStoreOrdered(m_read);
+    m_read =old &RING_INDEX_MASK;
+    return true;
+}
+
+void FrameRing::resetStats()
+{
+    m_received.storeRelaxed(0);
+    m_displayed.storeRelaxed(0);
+    m_dropped.storeRelaxed(0);
+}
+
+StreamStats FrameRing::stats() const
+{
+    StreamStats s;
+    s.received =m_received.loadRelaxed();
+    s.displayed =m_displayed.loadRelaxed();
+    s.dropped =m_dropped.loadRelaxed();
+    return s;
+}
+
+
+//class FrameSource  帧源线程
+
+FrameSource::FrameSource(QObject *parent) :QThread(parent), m_ring(nullptr), m_fps(0)
+{
+
+}
+
+FrameSource::~FrameSource()
+{
+    stop();
+}
+
+/**
+ * @brief FrameSource::start  开始向ring推送帧
+ * @param ring
+ */
+void FrameSource::start(FrameRing *ring)
+{
+    stop();
+    m_ring =ring;
+    m_stop.storeRelease(0);
+    QThread::start();
+}
+
+/**
+ * @brief FrameSource::stop  停止并等待线程退出
+ */
+void FrameSource::stop()
+{
+    m_stop.storeRelease(1);
+    wait();
+}
+
+/**
+ * @brief FrameSource::run
+ * 取帧循环，m_fps >0时按帧率节拍，否则尽可能快
+ */
+void FrameSource::run()
+{
+    if(!m_ring || !open())  return;
+    QElapsedTimer timer;
+    timer.start();
+    qint64 frameIndex =0;
+    while(!m_stop.loadAcquire()){
+        if(!grab(m_ring->writeBuffer()))  break;
+        m_ring->publish();
+        ++frameIndex;
+        if(m_fps >0){
+            qint64 due =qint64(frameIndex *1e9 /m_fps);
+            qint64 remain =due -timer.nsecsElapsed();
+            if(remain >0)  usleep(static_cast<unsigned long>(remain /1000));
+        }
+    }
+    close();
+    emit finishedStreaming();
+}
+
+
+//class FileFrameSource  视频文件/图像序列帧源
+
+struct FileFrameSource::Capture
+{
+    cv::VideoCapture video;
+};
+
+FileFrameSource::FileFrameSource(const QString &path, QObject *parent) :FrameSource(parent),
+    m_path(path), m_index(0), m_loop(true), m_capture(nullptr)
+{
+
+}
+
+FileFrameSource::~FileFrameSource()
+{
+    stop();
+    delete m_capture;
+}
+
+bool FileFrameSource::open()
+{
+    m_index =0;
+    QFileInfo info(m_path);
+    if(info.isDir()){
+        QStringList filters;
+        filters <<"*.jpg" <<"*.jpeg" <<"*.png" <<"*.bmp" <<"*.tif" <<"*.tiff";
+        m_files.clear();
+        QDir dir(m_path);
+        for(const QString &name :dir.entryList(filters, QDir::Files, QDir::Name))
+            m_files <<dir.absoluteFilePath(name);
+        if(frameRate() <=0)  setFrameRate(60);
+        return !m_files.isEmpty();
+    }
+    if(!m_capture)  m_capture =new Capture;
+    if(!m_capture->video.open(m_path.toLocal8Bit().toStdString()))  return false;
+    if(frameRate() <=0)  setFrameRate(m_capture->video.get(cv::CAP_PROP_FPS));
+    return true;
+}
+
+/**
+ * @brief FileFrameSource::grab
+ * 视频帧直接解码到frame的缓冲中；图像序列逐个读取
+ * @param frame
+ * @return
+ */
+bool FileFrameSource::grab(cv::Mat &frame)
+{
+    if(!m_files.isEmpty()){
+        if(m_index >=m_files.size()){
+            if(!m_loop)  return false;
+            m_index =0;
+        }
+        frame =cv::imread(m_files.at(m_index++).toLocal8Bit().toStdString(), cv::IMREAD_ANYCOLOR);
+        return !frame.empty();
+    }
+    if(m_capture->video.read(frame))  return true;
+    if(!m_loop)  return false;
+    m_capture->video.set(cv::CAP_PROP_POS_FRAMES, 0);
+    return m_capture->video.read(frame);
+}
+
+void FileFrameSource::close()
+{
+    if(m_capture)  m_capture->video.release();
+}
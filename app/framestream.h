@@ -0,0 +1,113 @@
+#ifndef FRAMESTREAM_H
+#define FRAMESTREAM_H
+
+/**
+实时图像流：三缓冲帧环与帧源(相机/视频文件/图像序列目录)
+**/
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QStringList>
+#include <functional>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief The StreamStats struct  流统计：收到、显示、丢弃的帧数
+ */
+struct StreamStats
+{
+    quint64 received;
+    quint64 displayed;
+    quint64 dropped;
+};
+
+/**
+ * @brief The FrameRing class
+ * 单生产者单消费者的无锁三缓冲：生产者写入writeBuffer()后publish()，与待取缓冲交换；
+ * 消费者acquire()取走最新一帧。消费者来不及取时，新帧覆盖待取帧并计为丢帧，生产者永不阻塞。
+ * 各缓冲在帧尺寸和类型不变时重复使用，不重新分配
+ */
+class FrameRing
+{
+public:
+    FrameRing();
+    ~FrameRing();
+
+    cv::Mat& writeBuffer()  { return m_buffers[m_write];}
+    void publish();
+    bool acquire();
+    const cv::Mat& readBuffer() const  { return m_buffers[m_read];}
+
+    void setNotifier(const std::function<void()> &notifier)  { m_notifier =notifier;}
+    void markDisplayed()  { m_displayed.fetchAndAddRelaxed(1);}
+    void resetStats();
+    StreamStats stats() const;
+private:
+    enum {RING_FRESH =4, RING_INDEX_MASK =3};
+    cv::Mat m_buffers[3];
+    int m_write;
+    int m_read;
+    QAtomicInt m_pending;
+    QAtomicInteger<quint64> m_received;
+    QAtomicInteger<quint64> m_displayed;
+    QAtomicInteger<quint64> m_dropped;
+    std::function<void()> m_notifier;
+};
+
+
+/**
+ * @brief The FrameSource class
+ * 帧源线程基类，子类实现grab()，线程循环取帧写入FrameRing并按帧率节拍
+ */
+class FrameSource :public QThread
+{
+    Q_OBJECT
+public:
+    FrameSource(QObject *parent =nullptr);
+    ~FrameSource();
+
+    void start(FrameRing *ring);
+    void stop();
+    void setFrameRate(double fps)  { m_fps =fps;}
+    double frameRate() const  { return m_fps;}
+protected:
+    virtual bool open()  { return true;}
+    virtual bool grab(cv::Mat &frame) =0;
+    virtual void close()  {}
+    void run() override;
+private:
+    FrameRing *m_ring;
+    QAtomicInt m_stop;
+    double m_fps;
+signals:
+    void finishedStreaming();
+};
+
+
+/**
+ * @brief The FileFrameSource class
+ * 离线帧源：视频文件(cv::VideoCapture)或图像序列目录(按文件名排序)，可循环播放，
+ * 用于在没有相机时测试实时显示模式
+ */
+class FileFrameSource :public FrameSource
+{
+    Q_OBJECT
+public:
+    FileFrameSource(const QString &path, QObject *parent =nullptr);
+    ~FileFrameSource();
+
+    void setLoop(bool loop)  { m_loop =loop;}
+protected:
+    bool open() override;
+    bool grab(cv::Mat &frame) override;
+    void close() override;
+private:
+    QString m_path;
+    QStringList m_files;
+    int m_index;
+    bool m_loop;
+    struct Capture;
+    Capture *m_capture;
+};
+
+#endif // FRAMESTREAM_H
@@ -0,0 +1,566 @@
+#include "imageitems.h"
+#include "visioncom.h"
+#include "pixelconvert.h"
+
+#include <cmath>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtConcurrent/QtConcurrentRun>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#define TILE_CACHE_DEFAULT_MB 256 //块缓存默认上限
+
+/**
+ * @brief imageLayout  QImage格式对应的cv::Mat类型，rgbOrder表示3通道为RGB顺序
+ * @return  不支持直接读写的格式返回false
+ */
+static bool imageLayout(QImage::Format format, int &type, bool &rgbOrder)
+{
+    rgbOrder =false;
+    switch (format) {
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+        type =CV_8UC1;
+        return true;
+    case QImage::Format_RGB888:
+        type =CV_8UC3;
+        rgbOrder =true;
+        return true;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    case QImage::Format_BGR888:
+        type =CV_8UC3;
+        return true;
+#endif
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        type =CV_8UC4;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief readPatch  读取img中rect区域，返回灰度或BGR(A)顺序的Mat，能共享时不拷贝
+ */
+static cv::Mat readPatch(const QImage &img, const QRect &rect)
+{
+    int type;
+    bool rgbOrder;
+    if(!imageLayout(img.format(), type, rgbOrder))  return cv::Mat();
+    cv::Mat view(img.height(), img.width(), type, (void*)img.constBits(), img.bytesPerLine());
+    view =view(cv::Rect(rect.x(), rect.y(), rect.width(), rect.height()));
+    if(!rgbOrder)  return view;
+    cv::Mat bgr;
+    cv::cvtColor(view, bgr, cv::COLOR_RGB2BGR);
+    return bgr;
+}
+
+/**
+ * @brief writePatch  将灰度或BGR(A)顺序的patch按img的格式写入rect区域，只触及该区域的像素
+ */
+static void writePatch(QImage &img, const QRect &rect, const cv::Mat &patch)
+{
+    int type;
+    bool rgbOrder;
+    if(!imageLayout(img.format(), type, rgbOrder))  return;
+    cv::Mat view(img.height(), img.width(), type, img.bits(), img.bytesPerLine());
+    cv::Mat dst =view(cv::Rect(rect.x(), rect.y(), rect.width(), rect.height()));
+    int code =-1;
+    switch (patch.channels() *10 +CV_MAT_CN(type)) {
+    case 13:  code =rgbOrder ? cv::COLOR_GRAY2RGB : cv::COLOR_GRAY2BGR; break;
+    case 14:  code =cv::COLOR_GRAY2BGRA; break;
+    case 31:  code =cv::COLOR_BGR2GRAY; break;
+    case 33:  code =rgbOrder ? cv::COLOR_BGR2RGB : -1; break;
+    case 34:  code =cv::COLOR_BGR2BGRA; break;
+    case 41:  code =cv::COLOR_BGRA2GRAY; break;
+    case 43:  code =rgbOrder ? cv::COLOR_BGRA2RGB : cv::COLOR_BGRA2BGR; break;
+    default:  break;
+    }
+    if(code <0)
+        patch.copyTo(dst);
+    else
+        cv::cvtColor(patch, dst, code);
+}
+
+//class TiledImageItem  分块金字塔图像
+
+TiledImageItem::TiledImageItem(QGraphicsItem *parent) :QGraphicsObject(parent), m_paintedByView(false), m_baseKey(0),
+    m_sourceKey(nullptr)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setTileCacheLimit(TILE_CACHE_DEFAULT_MB);
+    connect(&m_pyramidWatcher, &QFutureWatcher<QVector<QImage> >::finished, this, &TiledImageItem::onPyramidBuilt);
+    connect(&m_sourceWatcher, &QFutureWatcher<QVector<cv::Mat> >::finished, this, &TiledImageItem::onSourcePyramidBuilt);
+}
+
+TiledImageItem::~TiledImageItem()
+{
+
+}
+
+/**
+ * @brief TiledImageItem::setImage
+ * 设置图像(浅拷贝)，清空块缓存并在后台生成金字塔
+ * @param img
+ */
+void TiledImageItem::setImage(const QImage &img)
+{
+    prepareGeometryChange();
+    clearLevels();
+    if(!img.isNull()){
+        m_levels <<img;
+        m_baseKey =img.cacheKey();
+        m_pyramidWatcher.setFuture(QtConcurrent::run(&TiledImageItem::buildPyramid, img));
+    }
+    update();
+    emit contentChanged(QRectF());
+}
+
+/**
+ * @brief TiledImageItem::setSource
+ * 设置图像(浅拷贝)。8位图像等同于setImage；其他位深保留原始数据，统计一次范围后按最小最大值显示，
+ * 后台生成原始数据的金字塔，块在绘制时才映射
+ * @param src  1/3/4通道
+ */
+void TiledImageItem::setSource(const cv::Mat &src)
+{
+    if(src.empty() || src.depth() ==CV_8U){
+        setImage(cvMat2QImageShared(src));
+        return;
+    }
+    prepareGeometryChange();
+    clearLevels();
+    m_mapper.setSource(src);
+    m_sourceLevels <<src;
+    m_sourceKey =src.data;
+    m_sourceWatcher.setFuture(QtConcurrent::run(&TiledImageItem::buildSourcePyramid, src));
+    update();
+    emit contentChanged(QRectF());
+}
+
+/**
+ * @brief TiledImageItem::setDisplayRange
+ * 高位深图像的显示范围[low, high]，只作废块缓存，可见的块在下次绘制时重新映射
+ * @param low
+ * @param high
+ */
+void TiledImageItem::setDisplayRange(double low, double high)
+{
+    m_mapper.setRange(low, high);
+    remapTiles();
+}
+
+/**
+ * @brief TiledImageItem::setDisplayColorMap  高位深图像的伪彩色，-1为灰度
+ * @param colormap
+ */
+void TiledImageItem::setDisplayColorMap(int colormap)
+{
+    m_mapper.setColorMap(colormap);
+    remapTiles();
+}
+
+/**
+ * @brief TiledImageItem::updateRegion
+ * 局部更新：只改写rect内的像素，重算各层对应的小区域并作废相交的块，开销与rect面积成正比。
+ * 第0层与外部共享数据时，第一次更新会分离出一份副本。patch与图像使用同一数值尺度：
+ * 高位深图像(setSource)写入原始数据，显示时按整幅图像的显示范围映射；8位图像的非8位patch按数值饱和转换。
+ * 不按patch自身的最小最大值拉伸，否则相邻的局部更新亮度不一致，在边界出现接缝
+ * @param rect  图像像素坐标
+ * @param patch  大小与rect一致；灰度或BGR(A)，高位深图像时通道数须与图像一致
+ */
+void TiledImageItem::updateRegion(const QRect &rect, const cv::Mat &patch)
+{
+    if(levelCount() ==0 || patch.empty())  return;
+    QRect area =rect.intersected(QRect(QPoint(0, 0), levelSize(0)));
+    if(area.isEmpty())  return;
+    if(isMapped()){
+        //原始数据直接写入第0层，第一次更新时与外部分离；显示范围仍为整幅图像的范围
+        cv::Mat &base =m_sourceLevels.first();
+        if(patch.channels() !=base.channels())  return;
+        if(!base.u || base.u->refcount >1)
+            base =base.clone();
+        cv::Mat src =patch;
+        if(src.depth() !=base.depth())
+            patch.convertTo(src, base.depth());
+        src(cv::Rect(area.x() -rect.x(), area.y() -rect.y(), area.width(), area.height()))
+                .copyTo(base(cv::Rect(area.x(), area.y(), area.width(), area.height())));
+        removeTiles(0, area);
+        if(m_sourceWatcher.isRunning())
+            m_pendingRegion +=area;
+        else
+            refreshLevels(area);
+        update(QRectF(area));
+        emit contentChanged(QRectF(area));
+        return;
+    }
+    cv::Mat src =patch;
+    if(src.depth() !=CV_8U)
+        patch.convertTo(src, CV_8U);
+    src =src(cv::Rect(area.x() -rect.x(), area.y() -rect.y(), area.width(), area.height()));
+
+    QImage &base =m_levels.first();
+    int type;
+    bool rgbOrder;
+    if(!imageLayout(base.format(), type, rgbOrder)){
+        base =base.convertToFormat(QImage::Format_ARGB32);
+        m_tiles.clear();
+    }
+    writePatch(base, area, src);
+    removeTiles(0, area);
+    if(m_pyramidWatcher.isRunning())
+        m_pendingRegion +=area;
+    else
+        refreshLevels(area);
+    update(QRectF(area));
+    emit contentChanged(QRectF(area));
+}
+
+/**
+ * @brief TiledImageItem::image  第0层图像，高位深图像按当前显示范围映射整幅图像
+ * @return
+ */
+QImage TiledImageItem::image()
+{
+    if(isMapped())  return m_mapper.map(m_sourceLevels.first());
+    return m_levels.isEmpty() ? QImage() : m_levels.first();
+}
+
+/**
+ * @brief TiledImageItem::setTileCacheLimit  块缓存内存上限
+ * @param megaBytes
+ */
+void TiledImageItem::setTileCacheLimit(int megaBytes)
+{
+    m_tiles.setMaxCost(megaBytes *1024);
+}
+
+QRectF TiledImageItem::boundingRect() const
+{
+    if(levelCount() ==0)  return QRectF();
+    return QRectF(QPointF(0, 0), levelSize(0));
+}
+
+/**
+ * @brief TiledImageItem::setPaintedByView
+ * 由视图在drawBackground中调用paintRegion绘制(配合背景缓存)，此时图形项自身不再绘制
+ * @param byView
+ */
+void TiledImageItem::setPaintedByView(bool byView)
+{
+    m_paintedByView =byView;
+    update();
+}
+
+void TiledImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    if(m_paintedByView)  return;
+    paintRegion(painter, option->exposedRect);
+}
+
+/**
+ * @brief TiledImageItem::paintRegion
+ * 只绘制rect覆盖到的块，按painter当前变换选层
+ * @param painter  坐标系为本图形项坐标
+ * @param rect  图形项坐标
+ */
+void TiledImageItem::paintRegion(QPainter *painter, const QRectF &rect)
+{
+    if(levelCount() ==0)  return;
+
+    qreal lod =QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    int level =levelForScale(lod);
+    int factor =1 <<level;
+    const QSize img =levelSize(level);
+    QRectF exposed =rect.intersected(boundingRect());
+    if(exposed.isEmpty())  return;
+
+    int sceneTile =TILE_SIZE *factor;
+    int tx0 =qMax(0, int(exposed.left()) /sceneTile);
+    int ty0 =qMax(0, int(exposed.top()) /sceneTile);
+    int tx1 =qMin((img.width() -1) /TILE_SIZE, int(std::ceil(exposed.right())) /sceneTile);
+    int ty1 =qMin((img.height() -1) /TILE_SIZE, int(std::ceil(exposed.bottom())) /sceneTile);
+    QRectF bounds =boundingRect();
+    for(int ty =ty0; ty <=ty1; ++ty){
+        for(int tx =tx0; tx <=tx1; ++tx){
+            QPixmap pm =tile(level, tx, ty);
+            //奇数尺寸图像的低分辨率层末行/列覆盖超出原图的半个像素，目标和源一同裁到图像范围内
+            QPointF origin(tx *sceneTile, ty *sceneTile);
+            QRectF target =QRectF(origin, QSizeF(pm.width() *factor, pm.height() *factor)).intersected(bounds);
+            if(target.isEmpty())  continue;
+            QRectF source((target.x() -origin.x()) /factor, (target.y() -origin.y()) /factor,
+                          target.width() /factor, target.height() /factor);
+            painter->drawPixmap(target, pm, source);
+        }
+    }
+}
+
+/**
+ * @brief TiledImageItem::levelForScale
+ * 选取分辨率不低于屏幕的最粗一层，即满足 1/2^level >=scale 的最大level
+ * @param scale  场景到设备的缩放比例
+ * @return
+ */
+int TiledImageItem::levelForScale(qreal scale) const
+{
+    int level =0;
+    if(scale >0 && scale <1)
+        level =int(std::floor(std::log2(1 /scale)));
+    return qBound(0, level, levelCount() -1);
+}
+
+/**
+ * @brief TiledImageItem::tile  取块，不在缓存中则从对应层生成
+ * @param level
+ * @param tx
+ * @param ty
+ * @return
+ */
+QPixmap TiledImageItem::tile(int level, int tx, int ty)
+{
+    quint64 key =tileKey(level, tx, ty);
+    if(QPixmap *cached =m_tiles.object(key))
+        return *cached;
+    QRect rect =QRect(tx *TILE_SIZE, ty *TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(QRect(QPoint(0, 0), levelSize(level)));
+    QPixmap pm;
+    if(isMapped())
+        pm =QPixmap::fromImage(m_mapper.map(m_sourceLevels[level](cv::Rect(rect.x(), rect.y(), rect.width(), rect.height()))));
+    else
+        pm =QPixmap::fromImage(m_levels[level].copy(rect));
+    int cost =qMax(1, pm.width() *pm.height() *pm.depth() /8 /1024);
+    m_tiles.insert(key, new QPixmap(pm), cost);
+    return pm;
+}
+
+/**
+ * @brief TiledImageItem::refreshLevels  由上一层重算rect在各低分辨率层中对应的区域
+ * @param rect  第0层像素坐标
+ */
+void TiledImageItem::refreshLevels(const QRect &rect)
+{
+    QRect prev =rect;
+    for(int level =1; level <m_sourceLevels.size(); ++level){
+        cv::Mat &img =m_sourceLevels[level];
+        QRect cur =QRect(QPoint(prev.left() /2, prev.top() /2),
+                         QPoint(prev.right() /2, prev.bottom() /2)).intersected(QRect(0, 0, img.cols, img.rows));
+        QRect src =QRect(cur.x() *2, cur.y() *2, cur.width() *2, cur.height() *2)
+                .intersected(QRect(QPoint(0, 0), levelSize(level -1)));
+        if(cur.isEmpty() || src.isEmpty())  break;
+        cv::Mat half;
+        cv::resize(m_sourceLevels[level -1](cv::Rect(src.x(), src.y(), src.width(), src.height())), half,
+                   cv::Size(cur.width(), cur.height()), 0, 0, cv::INTER_AREA);
+        half.copyTo(img(cv::Rect(cur.x(), cur.y(), cur.width(), cur.height())));
+        removeTiles(level, cur);
+        prev =cur;
+    }
+    for(int level =1; level <m_levels.size(); ++level){
+        QImage &img =m_levels[level];
+        QRect cur =QRect(QPoint(prev.left() /2, prev.top() /2),
+                         QPoint(prev.right() /2, prev.bottom() /2)).intersected(img.rect());
+        QRect src =QRect(cur.x() *2, cur.y() *2, cur.width() *2, cur.height() *2)
+                .intersected(m_levels[level -1].rect());
+        if(cur.isEmpty() || src.isEmpty())  break;
+        cv::Mat from =readPatch(m_levels[level -1], src);
+        if(from.empty())  break;
+        cv::Mat half;
+        cv::resize(from, half, cv::Size(cur.width(), cur.height()), 0, 0, cv::INTER_AREA);
+        writePatch(img, cur, half);
+        removeTiles(level, cur);
+        prev =cur;
+    }
+}
+
+/**
+ * @brief TiledImageItem::removeTiles  作废某层与levelRect相交的块
+ * @param level
+ * @param levelRect  该层像素坐标
+ */
+void TiledImageItem::removeTiles(int level, const QRect &levelRect)
+{
+    for(int ty =levelRect.top() /TILE_SIZE; ty <=levelRect.bottom() /TILE_SIZE; ++ty){
+        for(int tx =levelRect.left() /TILE_SIZE; tx <=levelRect.right() /TILE_SIZE; ++tx){
+            m_tiles.remove(tileKey(level, tx, ty));
+        }
+    }
+}
+
+QSize TiledImageItem::levelSize(int level) const
+{
+    if(isMapped())  return QSize(m_sourceLevels[level].cols, m_sourceLevels[level].rows);
+    return m_levels[level].size();
+}
+
+void TiledImageItem::clearLevels()
+{
+    m_tiles.clear();
+    m_levels.clear();
+    m_sourceLevels.clear();
+    m_sourceKey =nullptr;
+    m_mapper.setSource(cv::Mat());
+    m_pendingRegion =QRegion();
+}
+
+/**
+ * @brief TiledImageItem::remapTiles  显示映射变化，作废所有块并整体重绘
+ */
+void TiledImageItem::remapTiles()
+{
+    if(!isMapped())  return;
+    m_tiles.clear();
+    update();
+    emit contentChanged(QRectF());
+}
+
+quint64 TiledImageItem::tileKey(int level, int tx, int ty)
+{
+    return (quint64(level) <<48) |(quint64(ty) <<24) |quint64(tx);
+}
+
+/**
+ * @brief TiledImageItem::buildPyramid
+ * 后台线程执行：逐层减半直到整层不超过一个块
+ * @param base
+ * @return  包含第0层的各层图像
+ */
+QVector<QImage> TiledImageItem::buildPyramid(const QImage &base)
+{
+    QVector<QImage> levels;
+    levels <<base;
+    while(levels.last().width() >TILE_SIZE || levels.last().height() >TILE_SIZE){
+        QImage half =halfImage(levels.last());
+        if(half.isNull())  break;
+        levels <<half;
+    }
+    return levels;
+}
+
+/**
+ * @brief TiledImageItem::halfImage  面积插值缩小一半，Indexed8保留调色板
+ * @param img
+ * @return
+ */
+QImage TiledImageItem::halfImage(const QImage &img)
+{
+    QImageMat src(img);
+    if(src.mat().empty())  return QImage();
+    cv::Mat dst;
+    cv::resize(src.mat(), dst, cv::Size((img.width() +1) /2, (img.height() +1) /2), 0, 0, cv::INTER_AREA);
+    if(img.format() ==QImage::Format_Indexed8)
+        return cvMat2QImageShared(dst, img.colorTable());
+    return cvMat2QImageShared(dst);
+}
+
+/**
+ * @brief TiledImageItem::buildSourcePyramid  同buildPyramid，各层保持原始位深
+ * @param base
+ * @return
+ */
+QVector<cv::Mat> TiledImageItem::buildSourcePyramid(const cv::Mat &base)
+{
+    QVector<cv::Mat> levels;
+    levels <<base;
+    while(levels.last().cols >TILE_SIZE || levels.last().rows >TILE_SIZE){
+        const cv::Mat &last =levels.last();
+        cv::Mat half;
+        cv::resize(last, half, cv::Size((last.cols +1) /2, (last.rows +1) /2), 0, 0, cv::INTER_AREA);
+        levels <<half;
+    }
+    return levels;
+}
+
+/**
+ * @brief TiledImageItem::onPyramidBuilt
+ * 金字塔生成完成，丢弃已过期图像的结果；生成期间的局部更新在此补到低分辨率层
+ */
+void TiledImageItem::onPyramidBuilt()
+{
+    QVector<QImage> levels =m_pyramidWatcher.result();
+    if(m_levels.isEmpty() || levels.isEmpty() || levels.first().cacheKey() !=m_baseKey)
+        return;
+    levels[0] =m_levels.first();
+    m_levels =levels;
+    for(const QRect &rect :m_pendingRegion)
+        refreshLevels(rect);
+    m_pendingRegion =QRegion();
+    update();
+    emit contentChanged(QRectF());
+}
+
+/**
+ * @brief TiledImageItem::onSourcePyramidBuilt  同onPyramidBuilt，用于高位深图像
+ */
+void TiledImageItem::onSourcePyramidBuilt()
+{
+    QVector<cv::Mat> levels =m_sourceWatcher.result();
+    if(m_sourceLevels.isEmpty() || levels.isEmpty() || levels.first().data !=m_sourceKey)
+        return;
+    levels[0] =m_sourceLevels.first();
+    m_sourceLevels =levels;
+    for(const QRect &rect :m_pendingRegion)
+        refreshLevels(rect);
+    m_pendingRegion =QRegion();
+    update();
+    emit contentChanged(QRectF());
+}
+
+
+
+//class StreamImageItem  实时流图像
+
+StreamImageItem::StreamImageItem(QGraphicsItem *parent) :QGraphicsItem(parent)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+StreamImageItem::~StreamImageItem()
+{
+
+}
+
+/**
+ * @brief StreamImageItem::setFrame
+ * 8位1/3通道帧按行转换写入已有缓冲；其他类型退化为cvMat2QImage
+ * @param frame
+ */
+void StreamImageItem::setFrame(const cv::Mat &frame)
+{
+    if(frame.empty())  return;
+    QImage::Format format;
+    PixelKernel kernel;
+    if(frame.type() ==CV_8UC1){
+        format =QImage::Format_Grayscale8;
+        kernel =PIXEL_GRAY8_TO_GRAY8;
+    }
+    else if(frame.type() ==CV_8UC3){
+        format =QImage::Format_RGB888;
+        kernel =PIXEL_BGR888_TO_RGB888;
+    }
+    else{
+        prepareGeometryChange();
+        m_frame =cvMat2QImage(frame);
+        update();
+        return;
+    }
+    if(m_frame.format() !=format || m_frame.width() !=frame.cols || m_frame.height() !=frame.rows){
+        prepareGeometryChange();
+        m_frame =QImage(frame.cols, frame.rows, format);
+    }
+    convertPixels(frame, m_frame.bits(), m_frame.bytesPerLine(), kernel);
+    update();
+}
+
+QRectF StreamImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), m_frame.size());
+}
+
+void StreamImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    if(m_frame.isNull())  return;
+    QRectF exposed =option->exposedRect.intersected(boundingRect());
+    painter->drawImage(exposed, m_frame, exposed);
+}
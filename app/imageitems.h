@@ -0,0 +1,101 @@
+#ifndef IMAGEITEMS_H
+#define IMAGEITEMS_H
+
+/**
+DispImageView中用于显示背景图像的图形项
+**/
+
+#include <QGraphicsObject>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPixmap>
+#include <QRegion>
+#include <opencv2/core/core.hpp>
+#include "displaymapper.h"
+
+/**
+ * @brief The TiledImageItem class
+ * 分块金字塔图像：第0层为原图，第n层为原图的1/2^n，每层切分为TILE_SIZE见方的块。
+ * 绘制时按当前缩放比例选层，只为可见区域按需生成块的QPixmap，块缓存按LRU淘汰并限制总内存；
+ * 低分辨率层在setImage后由后台线程生成，生成前暂用第0层。
+ * 16位、浮点等高位深图像用setSource设置：各层保存原始数据，块在生成时才经常驻的DisplayMapper映射，
+ * 调整显示范围或伪彩色只作废块缓存，之后只有可见的块被重新映射
+ */
+class TiledImageItem :public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    enum {TILE_SIZE =256};
+
+    TiledImageItem(QGraphicsItem *parent =nullptr);
+    ~TiledImageItem();
+
+    void setImage(const QImage &img);
+    void setSource(const cv::Mat &src);
+    void updateRegion(const QRect &rect, const cv::Mat &patch);
+    QImage image();
+    int levelCount() const  { return isMapped() ? m_sourceLevels.size() : m_levels.size();}
+    bool isMapped() const  { return !m_sourceLevels.isEmpty();}
+    void setDisplayRange(double low, double high);
+    void setDisplayColorMap(int colormap);
+    const DisplayMapper& displayMapper() const  { return m_mapper;}
+    void setTileCacheLimit(int megaBytes);
+    void setPaintedByView(bool byView);
+    void paintRegion(QPainter *painter, const QRectF &rect);
+
+    QRectF boundingRect() const override;
+protected:
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+private:
+    QVector<QImage> m_levels;
+    bool m_paintedByView;
+    QCache<quint64, QPixmap> m_tiles;
+    QFutureWatcher<QVector<QImage> > m_pyramidWatcher;
+    qint64 m_baseKey;
+    QRegion m_pendingRegion;
+    DisplayMapper m_mapper;
+    QVector<cv::Mat> m_sourceLevels;    //高位深图像的各层原始数据
+    QFutureWatcher<QVector<cv::Mat> > m_sourceWatcher;
+    const uchar *m_sourceKey;
+
+    QSize levelSize(int level) const;
+    void clearLevels();
+    void remapTiles();
+    int levelForScale(qreal scale) const;
+    void refreshLevels(const QRect &rect);
+    void removeTiles(int level, const QRect &levelRect);
+    QPixmap tile(int level, int tx, int ty);
+    static quint64 tileKey(int level, int tx, int ty);
+    static QVector<QImage> buildPyramid(const QImage &base);
+    static QImage halfImage(const QImage &img);
+    static QVector<cv::Mat> buildSourcePyramid(const cv::Mat &base);
+private slots:
+    void onPyramidBuilt();
+    void onSourcePyramidBuilt();
+signals:
+    void contentChanged(const QRectF &rect);
+};
+
+
+/**
+ * @brief The StreamImageItem class
+ * 实时流显示：每帧直接转换写入常驻的QImage并绘制，尺寸和格式不变时不重新分配
+ */
+class StreamImageItem :public QGraphicsItem
+{
+public:
+    StreamImageItem(QGraphicsItem *parent =nullptr);
+    ~StreamImageItem();
+
+    void setFrame(const cv::Mat &frame);
+    QImage frame() const  { return m_frame;}
+
+    QRectF boundingRect() const override;
+protected:
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+private:
+    QImage m_frame;
+};
+
+#endif // IMAGEITEMS_H
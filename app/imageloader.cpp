@@ -0,0 +1,86 @@
+#include "imageloader.h"
+#include "visioncom.h"
+
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#define LOADER_PREVIEW_SCALE 4 //预览图缩小倍数，对应IMREAD_REDUCED_GRAYSCALE_4
+
+ImageLoader::ImageLoader(QObject *parent) :QObject(parent)
+{
+    m_pool.setMaxThreadCount(2);
+}
+
+ImageLoader::~ImageLoader()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief ImageLoader::load  异步加载图像，取消之前未完成的请求
+ * @param path
+ */
+void ImageLoader::load(const QString &path)
+{
+    int generation =m_generation.fetchAndAddOrdered(1) +1;
+    m_pool.clear();
+    QtConcurrent::run(&m_pool, [this, path, generation]{ run(path, generation);});
+}
+
+/**
+ * @brief ImageLoader::cancel  取消所有未完成的请求
+ */
+void ImageLoader::cancel()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_pool.clear();
+}
+
+/**
+ * @brief ImageLoader::run
+ * 工作线程执行，每个阶段结束后检查请求是否已被新请求取代；
+ * 结果转到GUI线程后再检查一次，保证过期结果不会发出
+ * @param path
+ * @param generation
+ */
+void ImageLoader::run(const QString &path, int generation)
+{
+    std::string file =path.toLocal8Bit().toStdString();
+    QString suffix =QFileInfo(path).suffix().toLower();
+    if(suffix =="jpg" || suffix =="jpeg"){
+        cv::Mat preview =cv::imread(file, cv::IMREAD_REDUCED_GRAYSCALE_4);
+        if(isStale(generation))  return;
+        if(!preview.empty()){
+            QImage image =cvMat2QImageShared(preview);
+            QMetaObject::invokeMethod(this, [this, image, generation]{
+                if(!isStale(generation))  emit previewReady(image, LOADER_PREVIEW_SCALE);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    cv::Mat mat =cv::imread(file, cv::IMREAD_ANYCOLOR |cv::IMREAD_ANYDEPTH);
+    if(isStale(generation))  return;
+    if(mat.empty()){
+        QMetaObject::invokeMethod(this, [this, path, generation]{
+            if(!isStale(generation))  emit loadFailed(path);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    cv::Mat gray;
+    if(mat.channels() ==1)
+        gray =mat;
+    else
+        cv::cvtColor(mat, gray, mat.channels() ==4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    mat.release();
+    if(isStale(generation))  return;
+
+    QImage image =gray.depth() ==CV_8U ? cvMat2QImageShared(gray) : QImage();
+    if(isStale(generation))  return;
+    QMetaObject::invokeMethod(this, [this, gray, image, generation]{
+        if(!isStale(generation))  emit imageReady(gray, image);
+    }, Qt::QueuedConnection);
+}
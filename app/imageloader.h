@@ -0,0 +1,38 @@
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QImage>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief The ImageLoader class
+ * 后台图像加载：解码 -> 转灰度 -> 显示转换，在线程池中执行，QPixmap由显示端按块懒生成。
+ * 只有8位图像在此做显示转换，高位深图像的imageReady中image为空，由显示端按块映射。
+ * 新的load()会使之前的请求失效，旧任务在各阶段之间检查并退出，其结果不会再发出。
+ * JPEG先以DCT缩放方式解码低分辨率预览(previewReady)，完整图像就绪后发出imageReady
+ */
+class ImageLoader :public QObject
+{
+    Q_OBJECT
+public:
+    ImageLoader(QObject *parent =nullptr);
+    ~ImageLoader();
+
+    void load(const QString &path);
+    void cancel();
+signals:
+    void previewReady(const QImage &image, qreal scale);
+    void imageReady(const cv::Mat &gray, const QImage &image);
+    void loadFailed(const QString &path);
+private:
+    QThreadPool m_pool;
+    QAtomicInt m_generation;
+
+    bool isStale(int generation) const  { return generation !=m_generation.loadAcquire();}
+    void run(const QString &path, int generation);
+};
+
+#endif // IMAGELOADER_H
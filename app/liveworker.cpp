@@ -0,0 +1,79 @@
+#include "liveworker.h"
+
+#include <QMutexLocker>
+
+//class LiveWorker  最新值优先任务线程
+
+LiveWorker::LiveWorker(QObject *parent) :QThread(parent), m_stop(false), m_generation(0)
+{
+
+}
+
+LiveWorker::~LiveWorker()
+{
+    stop();
+}
+
+/**
+ * @brief LiveWorker::post
+ * 投递任务，取代尚未执行的任务并取消正在执行的任务；线程未启动时自动启动
+ * @param job
+ * @return  任务代数
+ */
+int LiveWorker::post(const LiveJob &job)
+{
+    QMutexLocker locker(&m_mutex);
+    int generation =m_generation.fetchAndAddOrdered(1) +1;
+    m_pending =job;
+    m_stop =false;
+    if(!isRunning())  start();
+    m_condition.wakeOne();
+    return generation;
+}
+
+/**
+ * @brief LiveWorker::cancel  丢弃尚未执行的任务，已在执行的任务结果不再应用
+ */
+void LiveWorker::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_generation.fetchAndAddOrdered(1);
+    m_pending =LiveJob();
+}
+
+/**
+ * @brief LiveWorker::stop  取消任务并等待线程退出
+ */
+void LiveWorker::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_generation.fetchAndAddOrdered(1);
+        m_pending =LiveJob();
+        m_stop =true;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+
+void LiveWorker::run()
+{
+    forever{
+        LiveJob job;
+        int generation;
+        {
+            QMutexLocker locker(&m_mutex);
+            while(!m_stop && !m_pending)
+                m_condition.wait(&m_mutex);
+            if(m_stop)  return;
+            job.swap(m_pending);
+            generation =m_generation.loadAcquire();
+        }
+        LiveJobToken token(&m_generation, generation);
+        std::function<void()> apply =job(token);
+        if(!apply || token.isCancelled())  continue;
+        QMetaObject::invokeMethod(this, [this, generation, apply](){
+            if(isCurrent(generation))  apply();
+        }, Qt::QueuedConnection);
+    }
+}
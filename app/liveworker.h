@@ -0,0 +1,56 @@
+#ifndef LIVEWORKER_H
+#define LIVEWORKER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <functional>
+
+/**
+ * @brief The LiveJobToken class
+ * 任务取消标记，任务执行中应定期检查isCancelled()，被新任务取代后尽早返回
+ */
+class LiveJobToken
+{
+public:
+    LiveJobToken(const QAtomicInt *latest, int generation) :m_latest(latest), m_generation(generation)  {}
+    bool isCancelled() const  { return m_latest->loadAcquire() !=m_generation;}
+    int generation() const  { return m_generation;}
+private:
+    const QAtomicInt *m_latest;
+    int m_generation;
+};
+
+/**
+ * @brief LiveJob  在工作线程执行，返回在GUI线程应用结果的函数；被取消时返回空函数
+ */
+typedef std::function<std::function<void()>(const LiveJobToken &token)> LiveJob;
+
+/**
+ * @brief The LiveWorker class
+ * 最新值优先的单槽任务线程：post()覆盖尚未开始的任务，并使正在执行的任务的token失效；
+ * 结果回到GUI线程时再核对一次代数，过期结果直接丢弃。拖动时GUI线程只负责投递，不会堆积任务
+ */
+class LiveWorker :public QThread
+{
+    Q_OBJECT
+public:
+    LiveWorker(QObject *parent =nullptr);
+    ~LiveWorker();
+
+    int post(const LiveJob &job);
+    void cancel();
+    void stop();
+    bool isCurrent(int generation) const  { return m_generation.loadAcquire() ==generation;}
+protected:
+    void run() override;
+private:
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    LiveJob m_pending;
+    bool m_stop;
+    QAtomicInt m_generation;
+};
+
+#endif // LIVEWORKER_H
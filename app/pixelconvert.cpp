@@ -0,0 +1,237 @@
+#include "pixelconvert.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PIXEL_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define PIXEL_TARGET(arch) __attribute__((target(arch)))
+#else
+#define PIXEL_TARGET(arch)
+#endif
+
+#define PIXEL_PARALLEL_MIN (1 <<18)  //像素数小于该值时不并行，避免线程调度开销
+
+typedef void (*RowKernel)(const uchar *src, uchar *dst, int width);
+
+
+// 标量实现，同时处理SIMD循环剩余的尾部像素
+
+static void bgrToRgb888Row(const uchar *src, uchar *dst, int width, int x)
+{
+    for(; x <width; ++x){
+        const uchar *s =src +3 *x;
+        uchar *d =dst +3 *x;
+        uchar b =s[0];
+        d[1] =s[1];
+        d[0] =s[2];
+        d[2] =b;
+    }
+}
+
+static void bgrToRgb32Row(const uchar *src, uchar *dst, int width, int x)
+{
+    for(; x <width; ++x){
+        const uchar *s =src +3 *x;
+        uchar *d =dst +4 *x;
+        d[0] =s[0];
+        d[1] =s[1];
+        d[2] =s[2];
+        d[3] =0xff;
+    }
+}
+
+static void grayToRgb32Row(const uchar *src, uchar *dst, int width, int x)
+{
+    for(; x <width; ++x){
+        uchar g =src[x];
+        uchar *d =dst +4 *x;
+        d[0] =d[1] =d[2] =g;
+        d[3] =0xff;
+    }
+}
+
+static void bgrToRgb888C(const uchar *src, uchar *dst, int width)  { bgrToRgb888Row(src, dst, width, 0);}
+static void bgrToRgb32C(const uchar *src, uchar *dst, int width)  { bgrToRgb32Row(src, dst, width, 0);}
+static void grayToRgb32C(const uchar *src, uchar *dst, int width)  { grayToRgb32Row(src, dst, width, 0);}
+static void grayToGray8(const uchar *src, uchar *dst, int width)  { memcpy(dst, src, width);}
+
+
+#ifdef PIXEL_X86
+
+// SSSE3：每次读取16字节，处理其中4个像素(12字节)，写回16字节，多写的4字节由下一轮覆盖
+
+PIXEL_TARGET("ssse3")
+static void bgrToRgb888SSSE3(const uchar *src, uchar *dst, int width)
+{
+    const __m128i mask =_mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+    int x =0;
+    for(; x +6 <=width; x +=4){
+        __m128i v =_mm_loadu_si128((const __m128i*)(src +3 *x));
+        _mm_storeu_si128((__m128i*)(dst +3 *x), _mm_shuffle_epi8(v, mask));
+    }
+    bgrToRgb888Row(src, dst, width, x);
+}
+
+PIXEL_TARGET("ssse3")
+static void bgrToRgb32SSSE3(const uchar *src, uchar *dst, int width)
+{
+    const __m128i mask =_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha =_mm_set1_epi32(0xff000000);
+    int x =0;
+    for(; x +6 <=width; x +=4){
+        __m128i v =_mm_loadu_si128((const __m128i*)(src +3 *x));
+        v =_mm_or_si128(_mm_shuffle_epi8(v, mask), alpha);
+        _mm_storeu_si128((__m128i*)(dst +4 *x), v);
+    }
+    bgrToRgb32Row(src, dst, width, x);
+}
+
+PIXEL_TARGET("ssse3")
+static void grayToRgb32SSSE3(const uchar *src, uchar *dst, int width)
+{
+    const __m128i ff =_mm_set1_epi8(-1);
+    int x =0;
+    for(; x +16 <=width; x +=16){
+        __m128i g =_mm_loadu_si128((const __m128i*)(src +x));
+        __m128i gg0 =_mm_unpacklo_epi8(g, g);
+        __m128i gg1 =_mm_unpackhi_epi8(g, g);
+        __m128i ga0 =_mm_unpacklo_epi8(g, ff);
+        __m128i ga1 =_mm_unpackhi_epi8(g, ff);
+        __m128i *d =(__m128i*)(dst +4 *x);
+        _mm_storeu_si128(d, _mm_unpacklo_epi16(gg0, ga0));
+        _mm_storeu_si128(d +1, _mm_unpackhi_epi16(gg0, ga0));
+        _mm_storeu_si128(d +2, _mm_unpacklo_epi16(gg1, ga1));
+        _mm_storeu_si128(d +3, _mm_unpackhi_epi16(gg1, ga1));
+    }
+    grayToRgb32Row(src, dst, width, x);
+}
+
+// AVX2：读取32字节，用跨通道置换把像素0-3和4-7分别放到两个128位通道，再在通道内重排
+
+PIXEL_TARGET("avx2")
+static void bgrToRgb888AVX2(const uchar *src, uchar *dst, int width)
+{
+    const __m256i spread =_mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i gather =_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    const __m256i mask =_mm256_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15,
+                                         2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+    int x =0;
+    for(; x +11 <=width; x +=8){
+        __m256i v =_mm256_loadu_si256((const __m256i*)(src +3 *x));
+        v =_mm256_permutevar8x32_epi32(v, spread);
+        v =_mm256_shuffle_epi8(v, mask);
+        v =_mm256_permutevar8x32_epi32(v, gather);
+        _mm256_storeu_si256((__m256i*)(dst +3 *x), v);
+    }
+    bgrToRgb888Row(src, dst, width, x);
+}
+
+PIXEL_TARGET("avx2")
+static void bgrToRgb32AVX2(const uchar *src, uchar *dst, int width)
+{
+    const __m256i spread =_mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i mask =_mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha =_mm256_set1_epi32(0xff000000);
+    int x =0;
+    for(; x +11 <=width; x +=8){
+        __m256i v =_mm256_loadu_si256((const __m256i*)(src +3 *x));
+        v =_mm256_permutevar8x32_epi32(v, spread);
+        v =_mm256_or_si256(_mm256_shuffle_epi8(v, mask), alpha);
+        _mm256_storeu_si256((__m256i*)(dst +4 *x), v);
+    }
+    bgrToRgb32Row(src, dst, width, x);
+}
+
+PIXEL_TARGET("avx2")
+static void grayToRgb32AVX2(const uchar *src, uchar *dst, int width)
+{
+    const __m256i mul =_mm256_set1_epi32(0x00010101);
+    const __m256i alpha =_mm256_set1_epi32(0xff000000);
+    int x =0;
+    for(; x +8 <=width; x +=8){
+        __m256i g =_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src +x)));
+        g =_mm256_or_si256(_mm256_mullo_epi32(g, mul), alpha);
+        _mm256_storeu_si256((__m256i*)(dst +4 *x), g);
+    }
+    grayToRgb32Row(src, dst, width, x);
+}
+
+#endif // PIXEL_X86
+
+
+enum KernelLevel {LEVEL_C, LEVEL_SSSE3, LEVEL_AVX2};
+
+static KernelLevel detectLevel()
+{
+#ifdef PIXEL_X86
+    if(cv::checkHardwareSupport(CV_CPU_AVX2))  return LEVEL_AVX2;
+    if(cv::checkHardwareSupport(CV_CPU_SSSE3))  return LEVEL_SSSE3;
+#endif
+    return LEVEL_C;
+}
+
+static KernelLevel kernelLevel()
+{
+    static const KernelLevel level =detectLevel();
+    return level;
+}
+
+static RowKernel selectKernel(PixelKernel kernel)
+{
+    static const RowKernel table[3][4] ={
+        {bgrToRgb888C, bgrToRgb32C, grayToGray8, grayToRgb32C},
+#ifdef PIXEL_X86
+        {bgrToRgb888SSSE3, bgrToRgb32SSSE3, grayToGray8, grayToRgb32SSSE3},
+        {bgrToRgb888AVX2, bgrToRgb32AVX2, grayToGray8, grayToRgb32AVX2}
+#else
+        {bgrToRgb888C, bgrToRgb32C, grayToGray8, grayToRgb32C},
+        {bgrToRgb888C, bgrToRgb32C, grayToGray8, grayToRgb32C}
+#endif
+    };
+    return table[kernelLevel()][kernel];
+}
+
+/**
+ * @brief convertPixels
+ * 将src逐行转换写入dst，大图按行分块并行
+ * @param src  CV_8UC3(BGR)或CV_8UC1，类型须与kernel对应
+ * @param dst  目标首地址，至少容纳src.rows行
+ * @param dstStep  目标每行字节数
+ * @param kernel
+ */
+void convertPixels(const cv::Mat &src, uchar *dst, size_t dstStep, PixelKernel kernel)
+{
+    CV_Assert(src.type() ==((kernel ==PIXEL_BGR888_TO_RGB888 || kernel ==PIXEL_BGR888_TO_RGB32) ? CV_8UC3 : CV_8UC1));
+    RowKernel rowKernel =selectKernel(kernel);
+    const int width =src.cols;
+    auto body =[&](const cv::Range &range){
+        for(int row =range.start; row <range.end; ++row){
+            rowKernel(src.ptr<uchar>(row), dst +row *dstStep, width);
+        }
+    };
+    if(src.total() <PIXEL_PARALLEL_MIN)
+        body(cv::Range(0, src.rows));
+    else
+        cv::parallel_for_(cv::Range(0, src.rows), body);
+}
+
+/**
+ * @brief pixelKernelLevel  当前CPU选用的内核指令集，用于诊断输出
+ * @return
+ */
+const char* pixelKernelLevel()
+{
+    switch (kernelLevel()) {
+    case LEVEL_AVX2:
+        return "AVX2";
+    case LEVEL_SSSE3:
+        return "SSSE3";
+    default:
+        return "C";
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+/**
+显示通路使用的像素格式转换内核(SSSE3/AVX2)，运行时根据CPU选择实现，按行并行
+**/
+
+#include <opencv2/core/core.hpp>
+
+enum PixelKernel {PIXEL_BGR888_TO_RGB888,   //CV_8UC3 -> QImage::Format_RGB888，与RGB888->BGR888相同
+                  PIXEL_BGR888_TO_RGB32,    //CV_8UC3 -> QImage::Format_RGB32
+                  PIXEL_GRAY8_TO_GRAY8,     //CV_8UC1 -> QImage::Format_Grayscale8/Indexed8
+                  PIXEL_GRAY8_TO_RGB32};    //CV_8UC1 -> QImage::Format_RGB32
+
+void convertPixels(const cv::Mat &src, uchar *dst, size_t dstStep, PixelKernel kernel);
+const char* pixelKernelLevel();
+
+#endif // PIXELCONVERT_H
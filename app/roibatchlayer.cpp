@@ -0,0 +1,462 @@
+#include "roibatchlayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <QHash>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QGraphicsScene>
+#include <QGraphicsSceneMouseEvent>
+#include "simpleroi.h"
+#include "roishapes.h"
+
+#define BATCH_POINT_SIZE 4      //点标记半长(场景像素)
+#define BATCH_GRID_CELL 64      //索引格子大小
+
+//class RoiBatchLayer  大批量ROI显示层
+
+RoiBatchLayer::RoiBatchLayer(QGraphicsItem *parent) :QGraphicsObject(parent),
+    m_grid(BATCH_GRID_CELL), m_promotedId(-1)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+RoiBatchLayer::~RoiBatchLayer()
+{
+    demote();
+}
+
+void RoiBatchLayer::reserve(int count)
+{
+    m_kind.reserve(count);
+    m_hidden.reserve(count);
+    m_records.reserve(count);
+    m_vx.reserve(size_t(count) *4);
+    m_vy.reserve(size_t(count) *4);
+    m_color.reserve(count);
+    m_bounds.reserve(count);
+}
+
+void RoiBatchLayer::clear()
+{
+    demote();
+    prepareGeometryChange();
+    m_kind.clear();
+    m_hidden.clear();
+    m_records.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_color.clear();
+    m_bounds.clear();
+    m_grid.clear();
+    m_boundingRect =QRectF();
+}
+
+/**
+ * @brief RoiBatchLayer::addRect
+ * @param rect  场景坐标
+ * @return  ROI编号
+ */
+int RoiBatchLayer::addRect(const QRectF &rect)
+{
+    RoiRecord record =RoiRectShape(rect).toRecord();
+    record.flags =RoiRecord::FLAG_SUBPIXEL;
+    return append(record);
+}
+
+int RoiBatchLayer::addRotatedRect(const CaliperGeometry &geometry)
+{
+    return append(RoiCaliperShape::fromVertexes(geometry.vertexes, geometry.angle, geometry.shearAngle).toRecord());
+}
+
+int RoiBatchLayer::addPoint(const QPointF &point)
+{
+    return append(RoiPointShape(point).toRecord());
+}
+
+void RoiBatchLayer::setColor(int id, const QColor &color)
+{
+    if(id <0 || id >=count())  return;
+    m_color[id] =color.rgba();
+    update(m_bounds[id]);
+}
+
+/**
+ * @brief RoiBatchLayer::geometry  由双精度记录计算顶点，矩形和点的角度为0
+ * @param id
+ * @return
+ */
+CaliperGeometry RoiBatchLayer::geometry(int id) const
+{
+    const RoiRecord &rec =m_records[id];
+    CaliperGeometry geom;
+    switch (rec.type) {
+    case RoiRecord::ROI_CALIPER:{
+        RoiQuad quad;
+        caliperQuad(QPointF(rec.x, rec.y), rec.width, rec.height, rec.angle, rec.shearAngle, quad);
+        std::copy(quad.begin(), quad.begin() +4, geom.vertexes);
+        geom.angle =rec.angle;
+        geom.shearAngle =rec.shearAngle;
+        break;
+    }
+    case RoiRecord::ROI_RECT:{
+        QRectF rect(rec.x, rec.y, rec.width, rec.height);
+        geom.vertexes[0] =rect.topLeft();
+        geom.vertexes[1] =rect.topRight();
+        geom.vertexes[2] =rect.bottomRight();
+        geom.vertexes[3] =rect.bottomLeft();
+        break;
+    }
+    default:
+        std::fill(geom.vertexes, geom.vertexes +4, QPointF(rec.x, rec.y));
+        break;
+    }
+    return geom;
+}
+
+/**
+ * @brief RoiBatchLayer::record  配方记录，未经编辑的ROI与添加时完全相同
+ * @param id
+ * @return
+ */
+RoiRecord RoiBatchLayer::record(int id) const
+{
+    return m_records[id];
+}
+
+/**
+ * @brief RoiBatchLayer::records  导出全部ROI，正在交互的ROI先写回
+ * @param records  输出
+ */
+void RoiBatchLayer::records(std::vector<RoiRecord> &records)
+{
+    demote();
+    records.resize(m_kind.size());
+    for(int id =0; id <count(); id++)
+        records[id] =record(id);
+}
+
+/**
+ * @brief RoiBatchLayer::addRecords
+ * 批量添加配方记录(可直接传入RoiRecipe映射的记录)，预先分配存储；未知类型的记录跳过
+ * @param records
+ * @param count
+ */
+void RoiBatchLayer::addRecords(const RoiRecord *records, int count)
+{
+    reserve(this->count() +count);
+    for(int i =0; i <count; i++){
+        quint32 type =records[i].type;
+        if(type ==RoiRecord::ROI_RECT || type ==RoiRecord::ROI_CALIPER || type ==RoiRecord::ROI_POINT)
+            append(records[i]);
+    }
+}
+
+/**
+ * @brief RoiBatchLayer::roiAt
+ * 命中测试，只检查网格中pos附近格子里的ROI；重叠时返回编号最大(最后添加)的
+ * @param scenePos
+ * @param tolerance  边缘容差(场景像素)
+ * @return  未命中返回-1
+ */
+int RoiBatchLayer::roiAt(const QPointF &scenePos, qreal tolerance) const
+{
+    QPointF pos =mapFromScene(scenePos);
+    m_grid.query(QRectF(pos.x() -tolerance, pos.y() -tolerance, 2 *tolerance, 2 *tolerance), m_query);
+    int hit =-1;
+    for(int id : m_query){
+        if(id >hit && !m_hidden[id] && contains(id, pos, tolerance))
+            hit =id;
+    }
+    return hit;
+}
+
+/**
+ * @brief RoiBatchLayer::promote
+ * 将ROI提升为可交互图形加入场景，层中暂不绘制；之前提升的ROI先写回
+ * @param id
+ * @return  SimpleROI、CaliperTool或SimpleMovablePoint，由层管理生命周期
+ */
+QGraphicsObject* RoiBatchLayer::promote(int id)
+{
+    demote();
+    if(id <0 || id >=count() || !scene())  return nullptr;
+    QGraphicsObject *item =createRoiItem(m_records[id]);
+    if(!item)  return nullptr;
+    roiItemRecord(item, m_promotedRecord);
+    item->setZValue(zValue() +1);
+    item->setFlag(QGraphicsItem::ItemIsSelectable);
+    scene()->addItem(item);
+    RoiHitIndex::forScene(scene())->addItem(item);
+    item->setSelected(true);
+    m_promoted =item;
+    m_promotedId =id;
+    m_hidden[id] =1;
+    update(m_bounds[id]);
+    emit roiPromoted(id, item);
+    return item;
+}
+
+/**
+ * @brief RoiBatchLayer::demote  把交互图形编辑后的几何写回层中并删除交互图形
+ */
+void RoiBatchLayer::demote()
+{
+    if(m_promotedId <0)  return;
+    int id =m_promotedId;
+    m_promotedId =-1;
+    if(m_promoted){
+        RoiRecord rec;
+        QGraphicsObject *item =m_promoted.data();
+        if(roiItemRecord(item, rec)){
+            //记录为图形坐标，图形被整体拖动时加上其相对层的偏移
+            QPointF offset =mapFromScene(item->mapToScene(QPointF(0, 0)));
+            rec.x +=offset.x();
+            rec.y +=offset.y();
+            if(std::memcmp(&rec, &m_promotedRecord, sizeof(RoiRecord)) !=0){
+                RoiRecord before =m_records[id];
+                storeRecord(id, rec);
+                emit roiEdited(id, before, rec);
+            }
+        }
+        delete item;
+    }
+    m_hidden[id] =0;
+    update(m_bounds[id]);
+    emit roiDemoted(id);
+}
+
+QRectF RoiBatchLayer::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+/**
+ * @brief RoiBatchLayer::paint
+ * 只绘制与暴露区域相交的ROI，同色的边合并为一次drawLines；
+ * 在屏幕上小于2像素的ROI退化为点，用drawPoints一次画完
+ * @param painter
+ * @param option
+ * @param widget
+ */
+void RoiBatchLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    qreal lod =QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    m_grid.query(option->exposedRect, m_query);
+    if(m_query.empty())  return;
+
+    QHash<QRgb, QVector<QLineF> > lines;
+    QHash<QRgb, QVector<QPointF> > dots;
+    for(int id : m_query){
+        if(m_hidden[id])  continue;
+        const QRectF &b =m_bounds[id];
+        const float *x =&m_vx[id *4], *y =&m_vy[id *4];
+        if(b.width() *lod <2 && b.height() *lod <2){
+            dots[m_color[id]].append(b.center());
+            continue;
+        }
+        QVector<QLineF> &vec =lines[m_color[id]];
+        if(m_kind[id] ==ROI_POINT){
+            vec.append(QLineF(b.left(), y[0], b.right(), y[0]));
+            vec.append(QLineF(x[0], b.top(), x[0], b.bottom()));
+            continue;
+        }
+        for(int i =0; i <4; i++)
+            vec.append(QLineF(x[i], y[i], x[(i +1) %4], y[(i +1) %4]));
+    }
+
+    QPen pen;
+    pen.setCosmetic(true);
+    pen.setWidth(1);
+    for(auto it =lines.constBegin(); it !=lines.constEnd(); ++it){
+        pen.setColor(QColor::fromRgba(it.key()));
+        painter->setPen(pen);
+        painter->drawLines(it.value());
+    }
+    for(auto it =dots.constBegin(); it !=dots.constEnd(); ++it){
+        pen.setColor(QColor::fromRgba(it.key()));
+        painter->setPen(pen);
+        painter->drawPoints(it.value().constData(), it.value().size());
+    }
+}
+
+/**
+ * @brief RoiBatchLayer::mousePressEvent
+ * 单击ROI时提升为交互图形，并把这次按下转发给它：图形接受时由它抓取鼠标，拖动直接编辑该ROI，
+ * 释放时由sceneEventFilter解除抓取。单击空白处写回当前交互图形
+ * @param event
+ */
+void RoiBatchLayer::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->button() ==Qt::LeftButton){
+        int id =roiAt(event->scenePos());
+        if(id >=0){
+            QGraphicsObject *item =promote(id);
+            if(item){
+                event->setPos(item->mapFromScene(event->scenePos()));
+                event->setLastPos(item->mapFromScene(event->lastScenePos()));
+                event->setButtonDownPos(Qt::LeftButton, item->mapFromScene(event->buttonDownScenePos(Qt::LeftButton)));
+                event->accept();
+                scene()->sendEvent(item, event);
+                if(event->isAccepted()){
+                    item->installSceneEventFilter(this);
+                    item->grabMouse();
+                }
+            }
+            event->accept();
+            return;
+        }
+    }
+    demote();
+    event->ignore();
+}
+
+/**
+ * @brief RoiBatchLayer::sceneEventFilter  提升图形的鼠标释放：先交给图形处理，再解除按下时的显式抓取
+ * @param watched
+ * @param event
+ * @return
+ */
+bool RoiBatchLayer::sceneEventFilter(QGraphicsItem *watched, QEvent *event)
+{
+    if(event->type() !=QEvent::GraphicsSceneMouseRelease
+            || static_cast<QGraphicsSceneMouseEvent*>(event)->buttons() !=Qt::NoButton)
+        return false;
+    QPointer<QGraphicsObject> item =m_promoted;
+    watched->removeSceneEventFilter(this);
+    scene()->sendEvent(watched, event);
+    if(item && scene()->mouseGrabberItem() ==item.data())
+        item->ungrabMouse();
+    return true;
+}
+
+/**
+ * @brief RoiBatchLayer::itemChange  加入场景时跟踪其选择变化，用于写回提升的ROI
+ * @param change
+ * @param value
+ * @return
+ */
+QVariant RoiBatchLayer::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if(change ==ItemSceneChange){
+        demote();
+        if(scene())  disconnect(scene(), nullptr, this, nullptr);
+    }
+    else if(change ==ItemSceneHasChanged && scene()){
+        //排队执行：选择变化发生在场景的鼠标事件处理中，不能在其中删除图形
+        connect(scene(), &QGraphicsScene::selectionChanged, this, &RoiBatchLayer::onSelectionChanged,
+                Qt::QueuedConnection);
+    }
+    return QGraphicsObject::itemChange(change, value);
+}
+
+/**
+ * @brief RoiBatchLayer::onSelectionChanged  提升的图形不再被选中时写回
+ */
+void RoiBatchLayer::onSelectionChanged()
+{
+    if(m_promotedId >=0 && (!m_promoted || !m_promoted->isSelected()))
+        demote();
+}
+
+int RoiBatchLayer::append(const RoiRecord &record)
+{
+    int id =count();
+    m_kind.push_back(quint8(record.type ==RoiRecord::ROI_CALIPER ? ROI_ROTATED
+                            : record.type ==RoiRecord::ROI_POINT ? ROI_POINT : ROI_RECT));
+    m_hidden.push_back(0);
+    m_records.push_back(RoiRecord());
+    m_vx.resize(m_vx.size() +4);
+    m_vy.resize(m_vy.size() +4);
+    m_color.push_back(qRgb(0, 0, 139));
+    m_bounds.push_back(QRectF());
+    storeRecord(id, record);
+    return id;
+}
+
+/**
+ * @brief RoiBatchLayer::setRecord
+ * 改写第id个ROI的记录(撤销/重做等)，不发出roiEdited。该ROI正被提升时丢弃交互图形未写回的编辑，按新记录重新提升
+ * @param id
+ * @param record
+ */
+void RoiBatchLayer::setRecord(int id, const RoiRecord &record)
+{
+    if(id <0 || id >=count())  return;
+    bool promoted =id ==m_promotedId;
+    if(promoted){
+        m_promotedId =-1;
+        delete m_promoted.data();
+        m_hidden[id] =0;
+        emit roiDemoted(id);
+    }
+    storeRecord(id, record);
+    if(promoted)  promote(id);
+}
+
+/**
+ * @brief RoiBatchLayer::storeRecord  更新记录，并重建绘制缓存、外接矩形和网格索引
+ */
+void RoiBatchLayer::storeRecord(int id, const RoiRecord &record)
+{
+    m_records[id] =record;
+    QRectF old =m_bounds[id];
+    m_grid.remove(id, old);
+
+    CaliperGeometry geom =geometry(id);
+    const QPointF *vertexes =geom.vertexes;
+    qreal left =vertexes[0].x(), right =left, top =vertexes[0].y(), bottom =top;
+    for(int i =0; i <4; i++){
+        m_vx[id *4 +i] =float(vertexes[i].x());
+        m_vy[id *4 +i] =float(vertexes[i].y());
+        left =qMin(left, vertexes[i].x());
+        right =qMax(right, vertexes[i].x());
+        top =qMin(top, vertexes[i].y());
+        bottom =qMax(bottom, vertexes[i].y());
+    }
+    QRectF bounds(QPointF(left, top), QPointF(right, bottom));
+    if(m_kind[id] ==ROI_POINT)
+        bounds.adjust(-BATCH_POINT_SIZE, -BATCH_POINT_SIZE, BATCH_POINT_SIZE, BATCH_POINT_SIZE);
+    m_bounds[id] =bounds;
+    m_grid.insert(id, bounds);
+
+    //线宽为1个屏幕像素，外接矩形留出半个场景像素
+    QRectF area =bounds.adjusted(-0.5, -0.5, 0.5, 0.5);
+    if(!m_boundingRect.contains(area)){
+        prepareGeometryChange();
+        m_boundingRect =m_boundingRect.isNull() ? area : m_boundingRect.united(area);
+    }
+    if(!old.isNull())  update(old.adjusted(-0.5, -0.5, 0.5, 0.5));
+    update(area);
+}
+
+/**
+ * @brief RoiBatchLayer::contains
+ * 点在四边形内部或距边不超过tolerance；点类型按到中心的平方距离判断
+ */
+bool RoiBatchLayer::contains(int id, const QPointF &pos, qreal tolerance) const
+{
+    const float *x =&m_vx[id *4], *y =&m_vy[id *4];
+    qreal px =pos.x(), py =pos.y();
+    if(m_kind[id] ==ROI_POINT){
+        qreal dx =px -x[0], dy =py -y[0], r =BATCH_POINT_SIZE +tolerance;
+        return dx *dx +dy *dy <=r *r;
+    }
+    qreal area =0;
+    for(int i =0; i <4; i++){
+        int j =(i +1) %4;
+        area +=qreal(x[i]) *y[j] -qreal(x[j]) *y[i];
+    }
+    qreal sign =area >=0 ? 1 : -1;
+    for(int i =0; i <4; i++){
+        int j =(i +1) %4;
+        qreal ex =x[j] -x[i], ey =y[j] -y[i];
+        qreal len =std::sqrt(ex *ex +ey *ey);
+        if(len <=0)  continue;
+        qreal dist =sign *(ex *(py -y[i]) -ey *(px -x[i])) /len;
+        if(dist <-tolerance)  return false;
+    }
+    return true;
+}
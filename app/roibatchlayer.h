@@ -0,0 +1,82 @@
+#ifndef ROIBATCHLAYER_H
+#define ROIBATCHLAYER_H
+
+#include <QGraphicsObject>
+#include <QColor>
+#include <QPointer>
+#include <vector>
+#include "spatialgrid.h"
+#include "caliper.h"
+#include "roirecipe.h"
+
+/**
+ * @brief The RoiBatchLayer class
+ * 大批量ROI显示层：一个图形项以结构数组保存所有ROI(矩形、旋转矩形、点)的几何，
+ * 绘制时只取与暴露区域相交的ROI合并为一次drawLines，命中测试使用自己的均匀网格索引。
+ * 单击某个ROI时将其提升为可交互的SimpleROI/CaliperTool/SimpleMovablePoint并选中，同一次按下交给该图形，按住即可拖动编辑；
+ * 场景中该图形不再被选中(单击背景或选中其他图形)时把编辑后的几何写回并删除交互图形，几何有变化时发出roiEdited。
+ * 坐标均为场景坐标，层本身应位于原点。
+ * 几何以双精度的配方记录为准，float顶点数组只是绘制和命中测试的缓存，record()原样返回添加时的记录
+ */
+class RoiBatchLayer :public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    enum RoiKind {ROI_RECT, ROI_ROTATED, ROI_POINT};
+
+    RoiBatchLayer(QGraphicsItem *parent =nullptr);
+    ~RoiBatchLayer();
+
+    void reserve(int count);
+    void clear();
+    int count() const  { return int(m_kind.size());}
+    int addRect(const QRectF &rect);
+    int addRotatedRect(const CaliperGeometry &geometry);
+    int addPoint(const QPointF &point);
+    void setColor(int id, const QColor &color);
+    RoiKind kind(int id) const  { return RoiKind(m_kind[id]);}
+    QRectF bounds(int id) const  { return m_bounds[id];}
+    CaliperGeometry geometry(int id) const;
+    RoiRecord record(int id) const;
+    void setRecord(int id, const RoiRecord &record);
+    void records(std::vector<RoiRecord> &records);
+    void addRecords(const RoiRecord *records, int count);
+
+    int roiAt(const QPointF &scenePos, qreal tolerance =3) const;
+    QGraphicsObject* promote(int id);
+    void demote();
+    int promotedId() const  { return m_promotedId;}
+
+    QRectF boundingRect() const override;
+protected:
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+    void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+    bool sceneEventFilter(QGraphicsItem *watched, QEvent *event) override;
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+private:
+    std::vector<quint8> m_kind;
+    std::vector<quint8> m_hidden;
+    std::vector<RoiRecord> m_records;
+    std::vector<float> m_vx;     //绘制缓存，每个ROI 4个顶点，点类型只用第一个
+    std::vector<float> m_vy;
+    std::vector<QRgb> m_color;
+    std::vector<QRectF> m_bounds;
+    SpatialGrid m_grid;
+    QRectF m_boundingRect;
+    QPointer<QGraphicsObject> m_promoted;
+    int m_promotedId;
+    RoiRecord m_promotedRecord;     //提升时交互图形的记录，写回时未改动则保留原记录
+    mutable std::vector<int> m_query;
+
+    int append(const RoiRecord &record);
+    void storeRecord(int id, const RoiRecord &record);
+    bool contains(int id, const QPointF &pos, qreal tolerance) const;
+private slots:
+    void onSelectionChanged();
+signals:
+    void roiPromoted(int id, QGraphicsObject *item);
+    void roiDemoted(int id);
+    void roiEdited(int id, const RoiRecord &before, const RoiRecord &after);
+};
+
+#endif // ROIBATCHLAYER_H
@@ -0,0 +1,219 @@
+#include "roihistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QPainter>
+#include <QRegion>
+
+#define HIST_ITEM_WIDTH 256  //直方图显示宽度
+#define HIST_ITEM_HEIGHT 80  //直方图显示高度
+
+//class RoiHistogram  ROI增量直方图
+
+RoiHistogram::RoiHistogram() :m_bins(BINS, 0), m_count(0), m_bitDepth(0),
+    m_rangeMin(0), m_rangeMax(BINS), m_binScale(1)
+{
+
+}
+
+RoiHistogram::~RoiHistogram()
+{
+
+}
+
+/**
+ * @brief RoiHistogram::setImage  设置图像(浅拷贝)，确定分箱范围并清空直方图
+ * @param image
+ */
+void RoiHistogram::setImage(const cv::Mat &image)
+{
+    int type =image.type();
+    m_image =(type ==CV_8UC1 || type ==CV_16UC1 || type ==CV_32FC1) ? image : cv::Mat();
+    setupBins();
+    reset();
+}
+
+/**
+ * @brief RoiHistogram::setBitDepth
+ * 16位图像的有效位数(如10、12)，按[0, 2^bits)分箱使不同图像的直方图可比；0为按图像实际范围。
+ * 修改后清空直方图，需重新setRect
+ * @param bits  0或1~16
+ */
+void RoiHistogram::setBitDepth(int bits)
+{
+    bits =qBound(0, bits, 16);
+    if(bits ==m_bitDepth)  return;
+    m_bitDepth =bits;
+    if(m_image.depth() ==CV_16U){
+        setupBins();
+        reset();
+    }
+}
+
+/**
+ * @brief RoiHistogram::setupBins
+ * 8位箱号即灰度值；16位建立像素值到箱号的查找表，统计时每像素只查一次表；
+ * 32位浮点记录范围和比例，统计时计算箱号
+ */
+void RoiHistogram::setupBins()
+{
+    m_rangeMin =0;
+    m_rangeMax =BINS;
+    m_binScale =1;
+    m_lut.clear();
+    if(m_image.empty() || m_image.depth() ==CV_8U)  return;
+
+    double minValue =0, maxValue =0;
+    if(m_image.depth() ==CV_16U && m_bitDepth >0){
+        maxValue =(1 <<m_bitDepth) -1;
+    }
+    else if(m_image.depth() ==CV_16U){
+        cv::minMaxLoc(m_image, &minValue, &maxValue);
+    }
+    else{
+        //minMaxLoc会被NaN和无穷大干扰，逐像素只取有限值求范围
+        bool any =false;
+        for(int row =0; row <m_image.rows; ++row){
+            const float *p =m_image.ptr<float>(row);
+            for(int x =0; x <m_image.cols; ++x){
+                if(!std::isfinite(p[x]))  continue;
+                if(!any || p[x] <minValue)  minValue =p[x];
+                if(!any || p[x] >maxValue)  maxValue =p[x];
+                any =true;
+            }
+        }
+    }
+
+    if(m_image.depth() ==CV_16U){
+        //整数值v落在第(v -min) *BINS /(max -min +1)箱，最大值恰好落在最后一箱
+        double span =maxValue -minValue +1;
+        m_rangeMin =minValue;
+        m_rangeMax =maxValue +1;
+        m_lut.resize(65536);
+        for(int v =0; v <65536; ++v){
+            double bin =std::floor((v -minValue) *BINS /span);
+            m_lut[v] =quint8(std::min(std::max(bin, 0.0), double(BINS -1)));
+        }
+    }
+    else{
+        m_rangeMin =minValue;
+        m_rangeMax =maxValue;
+        m_binScale =maxValue >minValue ? BINS /(maxValue -minValue) : 0;
+    }
+}
+
+void RoiHistogram::reset()
+{
+    m_rect =QRect();
+    std::fill(m_bins.begin(), m_bins.end(), 0);
+    m_count =0;
+}
+
+/**
+ * @brief RoiHistogram::setRect
+ * 新旧矩形重叠较多时只减去旧矩形独有部分、加上新矩形独有部分，否则重新统计
+ * @param rect  图像坐标，超出图像的部分被裁掉
+ */
+void RoiHistogram::setRect(const QRect &rect)
+{
+    if(m_image.empty())  return;
+    QRect clipped =rect.intersected(QRect(0, 0, m_image.cols, m_image.rows));
+    if(clipped ==m_rect)  return;
+    QRect overlap =clipped.intersected(m_rect);
+    qint64 overlapArea =qint64(overlap.width()) *overlap.height();
+    qint64 newArea =qint64(clipped.width()) *clipped.height();
+    if(overlapArea *2 <newArea){
+        reset();
+        accumulate(clipped, 1);
+    }
+    else{
+        for(const QRect &r :QRegion(m_rect).subtracted(QRegion(clipped)))
+            accumulate(r, -1);
+        for(const QRect &r :QRegion(clipped).subtracted(QRegion(m_rect)))
+            accumulate(r, 1);
+    }
+    m_rect =clipped;
+}
+
+/**
+ * @brief RoiHistogram::accumulate  将rect内像素计入(sign =1)或移出(sign =-1)直方图，NaN不计入
+ * @param rect
+ * @param sign
+ */
+void RoiHistogram::accumulate(const QRect &rect, int sign)
+{
+    if(rect.isEmpty())  return;
+    quint32 *bins =m_bins.data();
+    int x0 =rect.x(), x1 =rect.x() +rect.width();
+    qint64 counted =qint64(rect.width()) *rect.height();
+    for(int row =rect.top(); row <=rect.bottom(); ++row){
+        if(m_image.depth() ==CV_8U){
+            const uchar *p =m_image.ptr<uchar>(row);
+            for(int x =x0; x <x1; ++x)
+                bins[p[x]] +=sign;
+        }
+        else if(m_image.depth() ==CV_16U){
+            const ushort *p =m_image.ptr<ushort>(row);
+            const quint8 *lut =m_lut.data();
+            for(int x =x0; x <x1; ++x)
+                bins[lut[p[x]]] +=sign;
+        }
+        else{
+            const float *p =m_image.ptr<float>(row);
+            const double lo =m_rangeMin, scale =m_binScale;
+            for(int x =x0; x <x1; ++x){
+                if(std::isnan(p[x])){
+                    counted--;
+                    continue;
+                }
+                double bin =(p[x] -lo) *scale;
+                bins[bin <=0 ? 0 : bin >=BINS -1 ? BINS -1 : int(bin)] +=sign;
+            }
+        }
+    }
+    m_count +=sign *counted;
+}
+
+
+//class HistogramItem  直方图叠加显示
+
+HistogramItem::HistogramItem(QGraphicsItem *parent) :QGraphicsItem(parent), m_peak(0)
+{
+    setFlag(QGraphicsItem::ItemIgnoresTransformations);
+}
+
+HistogramItem::~HistogramItem()
+{
+
+}
+
+void HistogramItem::setHistogram(const std::vector<quint32> &bins)
+{
+    m_bins =bins;
+    m_peak =m_bins.empty() ? 0 : *std::max_element(m_bins.begin(), m_bins.end());
+    update();
+}
+
+QRectF HistogramItem::boundingRect() const
+{
+    return QRectF(0, 0, HIST_ITEM_WIDTH, HIST_ITEM_HEIGHT);
+}
+
+void HistogramItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    painter->fillRect(boundingRect(), QColor(0, 0, 0, 160));
+    if(m_peak ==0)  return;
+    painter->setPen(QColor(0, 205, 0));
+    qreal xScale =qreal(HIST_ITEM_WIDTH) /m_bins.size();
+    QVector<QLineF> lines;
+    lines.reserve(int(m_bins.size()));
+    for(size_t i =0; i <m_bins.size(); ++i){
+        qreal h =HIST_ITEM_HEIGHT *qreal(m_bins[i]) /m_peak;
+        qreal x =(i +0.5) *xScale;
+        lines <<QLineF(x, HIST_ITEM_HEIGHT, x, HIST_ITEM_HEIGHT -h);
+    }
+    painter->drawLines(lines);
+}
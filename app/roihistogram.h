@@ -0,0 +1,69 @@
+#ifndef ROIHISTOGRAM_H
+#define ROIHISTOGRAM_H
+
+#include <QGraphicsItem>
+#include <QRect>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief The RoiHistogram class
+ * ROI矩形的灰度直方图(256箱)，矩形移动或缩放时只增减进入和离开的行列条带，
+ * 拖动时的开销与移动距离成正比，与图像大小无关。支持CV_8UC1、CV_16UC1和CV_32FC1：
+ * 8位按灰度值分箱；16位默认按整幅图像的实际最小最大值分箱(10/12位数据也铺满256箱)，
+ * 设置位深后按[0, 2^位深)分箱，超出的值计入最后一箱；32位浮点按有限值的实际范围分箱，
+ * 无穷大计入两端的箱，NaN不计入
+ */
+class RoiHistogram
+{
+public:
+    enum {BINS =256};
+
+    RoiHistogram();
+    ~RoiHistogram();
+
+    void setImage(const cv::Mat &image);
+    void setBitDepth(int bits);
+    int bitDepth() const  { return m_bitDepth;}
+    void setRect(const QRect &rect);
+    double rangeMin() const  { return m_rangeMin;}
+    double rangeMax() const  { return m_rangeMax;}
+    QRect rect() const  { return m_rect;}
+    const std::vector<quint32>& bins() const  { return m_bins;}
+    quint64 count() const  { return m_count;}
+private:
+    cv::Mat m_image;
+    QRect m_rect;
+    std::vector<quint32> m_bins;
+    quint64 m_count;
+    int m_bitDepth;                 //16位图像的有效位数，0为按实际范围
+    double m_rangeMin, m_rangeMax;  //第一箱下界和最后一箱上界
+    std::vector<quint8> m_lut;      //16位像素值到箱号
+    double m_binScale;              //32位浮点：(值 -m_rangeMin) *m_binScale为箱号
+
+    void setupBins();
+    void reset();
+    void accumulate(const QRect &rect, int sign);
+};
+
+
+/**
+ * @brief The HistogramItem class
+ * 直方图叠加显示，不随视图缩放
+ */
+class HistogramItem :public QGraphicsItem
+{
+public:
+    HistogramItem(QGraphicsItem *parent =nullptr);
+    ~HistogramItem();
+
+    void setHistogram(const std::vector<quint32> &bins);
+    QRectF boundingRect() const override;
+protected:
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+private:
+    std::vector<quint32> m_bins;
+    quint32 m_peak;
+};
+
+#endif // ROIHISTOGRAM_H
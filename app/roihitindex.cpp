@@ -0,0 +1,219 @@
+#include "roihitindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QGraphicsScene>
+#include <QGraphicsObject>
+
+#define HIT_GRID_CELL 32    //网格大小，与控制点尺寸同量级
+#define HIT_SLACK 1e-6      //图元测试放宽的量，场景/图形坐标换算的舍入不会漏掉候选，区域由hitRegion判定
+
+//class RoiHitIndex  场景级命中测试
+
+RoiHitIndex::RoiHitIndex(QGraphicsScene *scene) :QObject(scene), m_grid(HIT_GRID_CELL), m_dirty(false), m_pressing(false)
+{
+    setObjectName("RoiHitIndex");
+}
+
+/**
+ * @brief RoiHitIndex::forScene  每个场景一个索引，作为场景的子对象随场景销毁
+ * @param scene
+ * @return
+ */
+RoiHitIndex* RoiHitIndex::forScene(QGraphicsScene *scene)
+{
+    if(!scene)  return nullptr;
+    RoiHitIndex *index =scene->findChild<RoiHitIndex*>("RoiHitIndex", Qt::FindDirectChildrenOnly);
+    if(!index)  index =new RoiHitIndex(scene);
+    return index;
+}
+
+/**
+ * @brief RoiHitIndex::addItem  按下过程中加入的图形(如单击时提升的批量ROI)会重新查询本次按下的结果
+ * @param item  需实现RoiHitTarget，否则忽略
+ */
+void RoiHitIndex::addItem(QGraphicsObject *item)
+{
+    RoiHitTarget *target =dynamic_cast<RoiHitTarget*>(item);
+    if(!target || m_entries.contains(item))  return;
+    Entry entry;
+    entry.item =item;
+    entry.target =target;
+    entry.dirty =true;
+    m_entries.insert(item, entry);
+    m_dirty =true;
+
+    const char *changeSignals[] ={SIGNAL(ROIChanged()), SIGNAL(positionChanged())};
+    for(const char *sig : changeSignals){
+        if(item->metaObject()->indexOfSignal(sig +1) >=0)
+            connect(item, sig, this, SLOT(markDirty()));
+    }
+    connect(item, &QGraphicsObject::xChanged, this, &RoiHitIndex::markDirty);
+    connect(item, &QGraphicsObject::yChanged, this, &RoiHitIndex::markDirty);
+    connect(item, &QGraphicsObject::visibleChanged, this, &RoiHitIndex::markDirty);
+    connect(item, &QObject::destroyed, this, [this, item](){ removeItem(item);});
+    if(m_pressing)  m_press =hitTest(m_pressPos);
+}
+
+void RoiHitIndex::removeItem(QGraphicsObject *item)
+{
+    auto it =m_entries.find(item);
+    if(it ==m_entries.end())  return;
+    release(it.value());
+    m_entries.erase(it);
+    disconnect(item, nullptr, this, nullptr);
+}
+
+/**
+ * @brief RoiHitIndex::hitTest
+ * @param scenePos
+ * @return  命中的图形和该图形的区域编号
+ */
+RoiHit RoiHitIndex::hitTest(const QPointF &scenePos) const
+{
+    if(m_dirty){
+        for(auto it =m_entries.begin(); it !=m_entries.end(); ++it){
+            if(it.value().dirty)  rebuild(it.value());
+        }
+        m_dirty =false;
+    }
+
+    RoiHit hit;
+    int bestType =RoiHitShape::HIT_AREA +1;
+    qreal bestZ =0;
+    m_grid.query(scenePos, m_query);
+    m_checked.clear();
+    for(int id : m_query){
+        const IndexedShape &s =m_shapes[id];
+        if(!s.item->isVisible() || !s.bounds.contains(scenePos))  continue;
+        if(std::find(m_checked.begin(), m_checked.end(), s.item) !=m_checked.end())  continue;
+        if(!hits(s.shape, scenePos))  continue;
+        m_checked.push_back(s.item);
+        RoiHitShape::ShapeType type;
+        int region;
+        if(!s.target->hitRegion(scenePos, type, region))  continue;
+        int rank =type ==RoiHitShape::HIT_BOX ? RoiHitShape::HIT_HANDLE : type;
+        qreal z =s.item->zValue();
+        if(rank >bestType || (rank ==bestType && z <=bestZ))  continue;
+        hit.item =s.item;
+        hit.region =region;
+        bestType =rank;
+        bestZ =z;
+    }
+    return hit;
+}
+
+/**
+ * @brief RoiHitIndex::beginPress  视图收到鼠标按下时调用，查询结果保留到endPress
+ * @param scenePos
+ */
+void RoiHitIndex::beginPress(const QPointF &scenePos)
+{
+    m_press =hitTest(scenePos);
+    m_pressPos =scenePos;
+    m_pressing =true;
+}
+
+void RoiHitIndex::endPress()
+{
+    m_pressing =false;
+    m_press =RoiHit();
+}
+
+/**
+ * @brief RoiHitIndex::pressHit  图形的mousePressEvent中调用，不在视图分派的按下过程中时重新查询
+ * @param scenePos
+ * @return
+ */
+RoiHit RoiHitIndex::pressHit(const QPointF &scenePos) const
+{
+    if(m_pressing && scenePos ==m_pressPos)  return m_press;
+    return hitTest(scenePos);
+}
+
+/**
+ * @brief RoiHitIndex::markDirty  由图形的变化信号触发
+ */
+void RoiHitIndex::markDirty()
+{
+    QGraphicsObject *item =qobject_cast<QGraphicsObject*>(sender());
+    auto it =m_entries.find(item);
+    if(it ==m_entries.end())  return;
+    it.value().dirty =true;
+    m_dirty =true;
+}
+
+void RoiHitIndex::rebuild(Entry &entry) const
+{
+    release(entry);
+    m_scratch.clear();
+    entry.target->hitShapes(m_scratch);
+    for(const RoiHitShape &shape : m_scratch){
+        int n =(shape.type ==RoiHitShape::HIT_HANDLE || shape.type ==RoiHitShape::HIT_BOX) ? 1
+              : (shape.type ==RoiHitShape::HIT_EDGE ? 2 : 4);
+        qreal left =shape.points[0].x(), right =left, top =shape.points[0].y(), bottom =top;
+        for(int i =1; i <n; i++){
+            left =qMin(left, shape.points[i].x());
+            right =qMax(right, shape.points[i].x());
+            top =qMin(top, shape.points[i].y());
+            bottom =qMax(bottom, shape.points[i].y());
+        }
+        IndexedShape indexed;
+        indexed.shape =shape;
+        qreal margin =shape.radius +HIT_SLACK;
+        indexed.bounds =QRectF(QPointF(left, top), QPointF(right, bottom)).adjusted(-margin, -margin, margin, margin);
+        indexed.item =entry.item;
+        indexed.target =entry.target;
+        int id;
+        if(m_freeShapes.empty()){
+            id =int(m_shapes.size());
+            m_shapes.push_back(indexed);
+        }
+        else{
+            id =m_freeShapes.back();
+            m_freeShapes.pop_back();
+            m_shapes[id] =indexed;
+        }
+        m_grid.insert(id, indexed.bounds);
+        entry.shapes.push_back(id);
+    }
+    entry.dirty =false;
+}
+
+void RoiHitIndex::release(Entry &entry) const
+{
+    for(int id : entry.shapes){
+        m_grid.remove(id, m_shapes[id].bounds);
+        m_freeShapes.push_back(id);
+    }
+    entry.shapes.clear();
+}
+
+/**
+ * @brief RoiHitIndex::hits  图元测试，只用平方距离和叉积；结果只决定候选图形
+ */
+bool RoiHitIndex::hits(const RoiHitShape &shape, const QPointF &pos)
+{
+    qreal r =shape.radius +HIT_SLACK;
+    qreal r2 =r *r;
+    switch (shape.type) {
+    case RoiHitShape::HIT_HANDLE:
+        return roiSquaredDistance(pos, shape.points[0]) <=r2;
+    case RoiHitShape::HIT_BOX:
+        return std::abs(pos.x() -shape.points[0].x()) <=r && std::abs(pos.y() -shape.points[0].y()) <=r;
+    case RoiHitShape::HIT_EDGE:
+        return roiSquaredSegmentDistance(pos, shape.points[0], shape.points[1]) <=r2;
+    default:{
+        int sign =0;
+        for(int i =0; i <4; i++){
+            const QPointF &a =shape.points[i], &b =shape.points[(i +1) %4];
+            qreal cross =(b.x() -a.x()) *(pos.y() -a.y()) -(b.y() -a.y()) *(pos.x() -a.x());
+            int s =cross >0 ? 1 : (cross <0 ? -1 : 0);
+            if(s ==0)  continue;
+            if(sign ==0)  sign =s;
+            else if(s !=sign)  return false;
+        }
+        return true;
+    }
+    }
+}
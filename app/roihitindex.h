@@ -0,0 +1,109 @@
+#ifndef ROIHITINDEX_H
+#define ROIHITINDEX_H
+
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QHash>
+#include <vector>
+#include "spatialgrid.h"
+#include "roigeometry.h"
+
+class QGraphicsScene;
+class QGraphicsObject;
+
+/**
+ * @brief The RoiHitShape struct
+ * 命中测试图元(场景坐标)：控制点为圆，方形控制点为半边长radius的轴对齐方框，边为带宽度的线段，区域为凸四边形；
+ * region为所属图形自己的区域编号。类型同时是优先级，HIT_BOX与HIT_HANDLE同级
+ */
+struct RoiHitShape
+{
+    enum ShapeType {HIT_HANDLE, HIT_EDGE, HIT_AREA, HIT_BOX};
+    ShapeType type;
+    int region;
+    qreal radius;
+    QPointF points[4];
+};
+
+/**
+ * @brief The RoiHitTarget class
+ * 可被RoiHitIndex索引的ROI图形实现此接口：hitShapes按场景坐标给出控制点、边和内部区域，须覆盖hitRegion的全部命中范围；
+ * hitRegion是图形自己的区域判定(与按下时的judgePosition相同)，索引只用图元找出候选图形，区域以hitRegion为准
+ */
+class RoiHitTarget
+{
+public:
+    virtual ~RoiHitTarget()  {}
+    virtual void hitShapes(std::vector<RoiHitShape> &shapes) const =0;
+    virtual bool hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const =0;
+};
+
+/**
+ * @brief The RoiHit struct  命中结果，item为空表示未命中
+ */
+struct RoiHit
+{
+    QGraphicsObject *item;
+    int region;
+    RoiHit() :item(nullptr), region(0)  {}
+};
+
+/**
+ * @brief The RoiHitIndex class
+ * 场景级命中测试服务：所有登记图形的控制点和边按外接矩形放入均匀网格，
+ * 查询只检查光标所在格子中的图元，全部用平方距离比较；图元命中的图形再由其hitRegion确认区域，
+ * 结果与图形自己的判定一致。优先级为控制点 >边 >内部，同级取Z值高的可见图形。
+ * 图形变化(ROIChanged/positionChanged/xChanged/yChanged)时只标记，下一次查询前重建该图形的图元。
+ * 鼠标按下由视图在beginPress/endPress之间分派：只查询一次，光标下依次收到事件的图形用pressHit取同一结果
+ */
+class RoiHitIndex :public QObject
+{
+    Q_OBJECT
+public:
+    static RoiHitIndex* forScene(QGraphicsScene *scene);
+
+    void addItem(QGraphicsObject *item);
+    void removeItem(QGraphicsObject *item);
+    bool contains(QGraphicsObject *item) const  { return m_entries.contains(item);}
+    RoiHit hitTest(const QPointF &scenePos) const;
+    void beginPress(const QPointF &scenePos);
+    void endPress();
+    RoiHit pressHit(const QPointF &scenePos) const;
+private:
+    explicit RoiHitIndex(QGraphicsScene *scene);
+
+    struct Entry
+    {
+        QGraphicsObject *item;
+        RoiHitTarget *target;
+        std::vector<int> shapes;
+        bool dirty;
+    };
+    struct IndexedShape
+    {
+        RoiHitShape shape;
+        QRectF bounds;
+        QGraphicsObject *item;
+        RoiHitTarget *target;
+    };
+    mutable QHash<QGraphicsObject*, Entry> m_entries;
+    mutable std::vector<IndexedShape> m_shapes;
+    mutable std::vector<int> m_freeShapes;
+    mutable SpatialGrid m_grid;
+    mutable bool m_dirty;
+    mutable std::vector<RoiHitShape> m_scratch;
+    mutable std::vector<int> m_query;
+    mutable std::vector<QGraphicsObject*> m_checked;
+    bool m_pressing;
+    QPointF m_pressPos;
+    RoiHit m_press;
+
+    void rebuild(Entry &entry) const;
+    void release(Entry &entry) const;
+    static bool hits(const RoiHitShape &shape, const QPointF &pos);
+private slots:
+    void markDirty();
+};
+
+#endif // ROIHITINDEX_H
@@ -0,0 +1,143 @@
+#include "roipipeline.h"
+
+//class RoiPipeline  ROI区域处理流水线
+
+RoiPipeline::RoiPipeline() :m_halo(0)
+{
+    setCacheLimit(CACHE_DEFAULT_MB);
+}
+
+RoiPipeline::~RoiPipeline()
+{
+
+}
+
+/**
+ * @brief RoiPipeline::addStage
+ * @param name
+ * @param stage
+ * @param halo  该步骤输出一个像素需要的邻域半径，如5x5滤波为2
+ */
+void RoiPipeline::addStage(const QString &name, const RoiStage &stage, int halo)
+{
+    Stage s;
+    s.name =name;
+    s.func =stage;
+    s.halo =qMax(0, halo);
+    m_stages.push_back(s);
+    m_halo +=s.halo;
+    invalidate();
+}
+
+void RoiPipeline::clearStages()
+{
+    m_stages.clear();
+    m_halo =0;
+    invalidate();
+}
+
+QString RoiPipeline::stageName(int index) const
+{
+    if(index <0 || index >=stageCount())  return QString();
+    return m_stages[index].name;
+}
+
+/**
+ * @brief RoiPipeline::setImage  共享image数据，调用方不应再原地修改；与当前图像相同时保留缓存
+ * @param image
+ */
+void RoiPipeline::setImage(const cv::Mat &image)
+{
+    if(image.data ==m_image.data && image.size() ==m_image.size() && image.type() ==m_image.type()
+            && image.step ==m_image.step)
+        return;
+    m_image =image;
+    invalidate();
+}
+
+/**
+ * @brief RoiPipeline::setCacheLimit  块结果缓存内存上限
+ * @param megaBytes
+ */
+void RoiPipeline::setCacheLimit(int megaBytes)
+{
+    m_tiles.setMaxCost(megaBytes *1024);
+}
+
+void RoiPipeline::invalidate()
+{
+    m_tiles.clear();
+}
+
+/**
+ * @brief RoiPipeline::run
+ * 执行流水线并拼出rect区域的结果，已缓存的块直接复用
+ * @param rect  图像像素坐标，超出图像的部分被裁掉
+ * @param output  输出，尺寸为裁剪后的rect，类型由最后一个步骤决定；没有步骤时为输入的视图
+ * @param cancelled  每块计算前检查，返回true时中止，已算完的块仍保留在缓存中
+ * @return
+ */
+bool RoiPipeline::run(const QRect &rect, cv::Mat &output, const std::function<bool()> &cancelled)
+{
+    if(m_image.empty())  return false;
+    QRect area =rect.intersected(QRect(0, 0, m_image.cols, m_image.rows));
+    if(area.isEmpty())  return false;
+    if(m_stages.empty()){
+        output =m_image(cv::Rect(area.x(), area.y(), area.width(), area.height()));
+        return true;
+    }
+
+    bool created =false;
+    for(int ty =area.top() /TILE_SIZE; ty <=area.bottom() /TILE_SIZE; ++ty){
+        for(int tx =area.left() /TILE_SIZE; tx <=area.right() /TILE_SIZE; ++tx){
+            if(cancelled && cancelled())  return false;
+            cv::Mat *result =tile(tx, ty);
+            if(!result)  return false;
+            QRect tileRect(tx *TILE_SIZE, ty *TILE_SIZE, result->cols, result->rows);
+            QRect part =tileRect.intersected(area);
+            if(!created){
+                output.create(area.height(), area.width(), result->type());
+                created =true;
+            }
+            if(result->type() !=output.type())  return false;
+            (*result)(cv::Rect(part.x() -tileRect.x(), part.y() -tileRect.y(), part.width(), part.height()))
+                    .copyTo(output(cv::Rect(part.x() -area.x(), part.y() -area.y(), part.width(), part.height())));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief RoiPipeline::tile
+ * 取(tx, ty)块的结果，未缓存时在扩展halo后的输入视图上依次执行各步骤，再裁回块大小
+ * @param tx
+ * @param ty
+ * @return  属于缓存，下一次调用tile()前有效
+ */
+cv::Mat* RoiPipeline::tile(int tx, int ty)
+{
+    quint64 key =(quint64(ty) <<32) |quint64(tx);
+    if(cv::Mat *cached =m_tiles.object(key))
+        return cached;
+
+    QRect tileRect =QRect(tx *TILE_SIZE, ty *TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(QRect(0, 0, m_image.cols, m_image.rows));
+    QRect src =tileRect.adjusted(-m_halo, -m_halo, m_halo, m_halo).intersected(QRect(0, 0, m_image.cols, m_image.rows));
+    cv::Mat in =m_image(cv::Rect(src.x(), src.y(), src.width(), src.height()));
+    for(size_t i =0; i <m_stages.size(); ++i){
+        cv::Mat &out =m_buffers[i %2];
+        if(out.datastart ==m_image.datastart)  out.release();   //上一轮的步骤可能直接输出了输入视图
+        m_stages[i].func(in, out);
+        if(out.rows !=src.height() || out.cols !=src.width())  return nullptr;
+        in =out;
+    }
+    cv::Mat crop =in(cv::Rect(tileRect.x() -src.x(), tileRect.y() -src.y(), tileRect.width(), tileRect.height()));
+    int cost =qMax(1, int(crop.total() *crop.elemSize() /1024));
+    if(cost >m_tiles.maxCost()){
+        crop.copyTo(m_uncached);
+        return &m_uncached;
+    }
+    cv::Mat *result =new cv::Mat;
+    crop.copyTo(*result);
+    m_tiles.insert(key, result, cost);
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef ROIPIPELINE_H
+#define ROIPIPELINE_H
+
+#include <QCache>
+#include <QRect>
+#include <QString>
+#include <functional>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief RoiStage  处理步骤，src为输入视图(不可修改)，结果写入dst
+ */
+typedef std::function<void(const cv::Mat &src, cv::Mat &dst)> RoiStage;
+
+/**
+ * @brief The RoiPipeline class
+ * ROI区域处理流水线：按注册顺序对图像的ROI子视图依次执行各步骤，不复制输入。
+ * 图像按TILE_SIZE分块计算，每块向外扩展各步骤halo之和，块结果与ROI位置无关并缓存，
+ * ROI移动或缩放时只计算新覆盖到的块。步骤或图像变化时缓存作废。
+ * 非线程安全，同一时间只能在一个线程中使用
+ */
+class RoiPipeline
+{
+public:
+    enum {TILE_SIZE =128, CACHE_DEFAULT_MB =64};
+
+    RoiPipeline();
+    ~RoiPipeline();
+
+    void addStage(const QString &name, const RoiStage &stage, int halo =0);
+    void clearStages();
+    int stageCount() const  { return int(m_stages.size());}
+    QString stageName(int index) const;
+
+    void setImage(const cv::Mat &image);
+    void setCacheLimit(int megaBytes);
+    void invalidate();
+    bool run(const QRect &rect, cv::Mat &output, const std::function<bool()> &cancelled =std::function<bool()>());
+private:
+    struct Stage
+    {
+        QString name;
+        RoiStage func;
+        int halo;
+    };
+    std::vector<Stage> m_stages;
+    int m_halo;
+    cv::Mat m_image;
+    QCache<quint64, cv::Mat> m_tiles;
+    cv::Mat m_buffers[2];
+    cv::Mat m_uncached;
+
+    cv::Mat* tile(int tx, int ty);
+};
+
+#endif // ROIPIPELINE_H
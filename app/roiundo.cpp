@@ -0,0 +1,152 @@
+#include "roiundo.h"
+
+#include <cstring>
+#include "simpleroi.h"
+#include "roibatchlayer.h"
+
+//class RoiEditCommand  单个ROI的一次编辑
+
+RoiEditCommand::RoiEditCommand(QGraphicsObject *item, const RoiRecord &before, const RoiRecord &after, QUndoCommand *parent)
+    :QUndoCommand(parent), m_item(item), m_before(before), m_after(after), m_applied(true)
+{
+    setText(QObject::tr("Edit ROI"));
+}
+
+void RoiEditCommand::undo()
+{
+    if(m_item)  RoiUndoRecorder::applyRecord(m_item, m_before);
+}
+
+void RoiEditCommand::redo()
+{
+    if(m_applied){
+        m_applied =false;
+        return;
+    }
+    if(m_item)  RoiUndoRecorder::applyRecord(m_item, m_after);
+}
+
+
+//class RoiBatchEditCommand  大批量ROI层中一个ROI的一次编辑
+
+RoiBatchEditCommand::RoiBatchEditCommand(RoiBatchLayer *layer, int id, const RoiRecord &before, const RoiRecord &after,
+                                         QUndoCommand *parent)
+    :QUndoCommand(parent), m_layer(layer), m_id(id), m_before(before), m_after(after), m_applied(true)
+{
+    setText(QObject::tr("Edit ROI"));
+}
+
+void RoiBatchEditCommand::undo()
+{
+    if(m_layer)  m_layer->setRecord(m_id, m_before);
+}
+
+void RoiBatchEditCommand::redo()
+{
+    if(m_applied){
+        m_applied =false;
+        return;
+    }
+    if(m_layer)  m_layer->setRecord(m_id, m_after);
+}
+
+
+//class RoiUndoRecorder  ROI编辑记录
+
+RoiUndoRecorder::RoiUndoRecorder(QObject *parent) :QObject(parent)
+{
+    m_stack.setUndoLimit(DEFAULT_UNDO_LIMIT);
+}
+
+/**
+ * @brief RoiUndoRecorder::setUndoLimit
+ * 设置最多保存的命令数，0为不限制。QUndoStack只能在空栈时修改上限，因此会先清空历史
+ * @param limit
+ */
+void RoiUndoRecorder::setUndoLimit(int limit)
+{
+    m_stack.clear();
+    m_stack.setUndoLimit(limit);
+}
+
+/**
+ * @brief RoiUndoRecorder::addItem  登记需要记录历史的图形
+ * @param item  SimpleROI、CaliperTool或SimpleMovablePoint，其余类型忽略
+ */
+void RoiUndoRecorder::addItem(QGraphicsObject *item)
+{
+    RoiRecord record;
+    if(!roiItemRecord(item, record))  return;
+    connect(item, SIGNAL(ROITransformStarted()), this, SLOT(beginGesture()), Qt::UniqueConnection);
+    connect(item, SIGNAL(ROITransformFinished()), this, SLOT(endGesture()), Qt::UniqueConnection);
+    connect(item, &QObject::destroyed, this, [this, item](){ m_pending.remove(item);});
+}
+
+void RoiUndoRecorder::removeItem(QGraphicsObject *item)
+{
+    m_pending.remove(item);
+    disconnect(item, nullptr, this, nullptr);
+}
+
+/**
+ * @brief RoiUndoRecorder::addLayer  登记大批量ROI层，提升的ROI编辑后写回时记录一条命令
+ * @param layer
+ */
+void RoiUndoRecorder::addLayer(RoiBatchLayer *layer)
+{
+    connect(layer, &RoiBatchLayer::roiEdited, this, [this, layer](int id, const RoiRecord &before, const RoiRecord &after){
+        m_stack.push(new RoiBatchEditCommand(layer, id, before, after));
+    });
+}
+
+/**
+ * @brief RoiUndoRecorder::pushEdit
+ * 记录一次非鼠标的编辑(如代码修改几何)，item须已是编辑后的状态；几何未变化时不压栈
+ * @param item
+ * @param before  编辑前的记录
+ */
+void RoiUndoRecorder::pushEdit(QGraphicsObject *item, const RoiRecord &before)
+{
+    RoiRecord after;
+    if(!roiItemRecord(item, after))  return;
+    if(std::memcmp(&before, &after, sizeof(RoiRecord)) ==0)  return;
+    m_stack.push(new RoiEditCommand(item, before, after));
+}
+
+/**
+ * @brief RoiUndoRecorder::applyRecord  把记录写回图形，并发出ROITransformFinished以便刷新依赖该ROI的结果
+ * @param item
+ * @param record
+ * @return
+ */
+bool RoiUndoRecorder::applyRecord(QGraphicsObject *item, const RoiRecord &record)
+{
+    bool applied =false;
+    if(SimpleROI *roi =qobject_cast<SimpleROI*>(item))
+        applied =roi->fromRecord(record);
+    else if(CaliperTool *caliper =qobject_cast<CaliperTool*>(item))
+        applied =caliper->fromRecord(record);
+    else if(SimpleMovablePoint *point =qobject_cast<SimpleMovablePoint*>(item))
+        applied =point->fromRecord(record);
+    if(applied)
+        QMetaObject::invokeMethod(item, "ROITransformFinished");
+    return applied;
+}
+
+void RoiUndoRecorder::beginGesture()
+{
+    QGraphicsObject *item =qobject_cast<QGraphicsObject*>(sender());
+    RoiRecord record;
+    if(item && roiItemRecord(item, record))
+        m_pending.insert(item, record);
+}
+
+void RoiUndoRecorder::endGesture()
+{
+    QGraphicsObject *item =qobject_cast<QGraphicsObject*>(sender());
+    auto it =m_pending.find(item);
+    if(it ==m_pending.end())  return;
+    RoiRecord before =it.value();
+    m_pending.erase(it);
+    pushEdit(item, before);
+}
@@ -0,0 +1,88 @@
+#ifndef ROIUNDO_H
+#define ROIUNDO_H
+
+/**
+ROI编辑的撤销/重做：每次鼠标操作(按下到释放)只记录一条命令，命令只保存该ROI操作前后的几何记录
+**/
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QUndoCommand>
+#include <QUndoStack>
+#include "roirecipe.h"
+
+class QGraphicsObject;
+class RoiBatchLayer;
+
+/**
+ * @brief The RoiEditCommand class
+ * 单个ROI的一次编辑，保存前后两条定长记录，撤销和重做都只改写这一个图形。
+ * 图形已被删除时撤销/重做不做任何事
+ */
+class RoiEditCommand :public QUndoCommand
+{
+public:
+    RoiEditCommand(QGraphicsObject *item, const RoiRecord &before, const RoiRecord &after, QUndoCommand *parent =nullptr);
+
+    void undo() override;
+    void redo() override;
+private:
+    QPointer<QGraphicsObject> m_item;
+    RoiRecord m_before;
+    RoiRecord m_after;
+    bool m_applied;     //压栈时图形已是编辑后的状态，第一次redo跳过
+};
+
+/**
+ * @brief The RoiBatchEditCommand class
+ * 大批量ROI层中一个ROI的一次编辑(提升后编辑、写回时产生)，撤销和重做通过RoiBatchLayer::setRecord改写该ROI。
+ * 层已被删除或已清空时撤销/重做不做任何事
+ */
+class RoiBatchEditCommand :public QUndoCommand
+{
+public:
+    RoiBatchEditCommand(RoiBatchLayer *layer, int id, const RoiRecord &before, const RoiRecord &after, QUndoCommand *parent =nullptr);
+
+    void undo() override;
+    void redo() override;
+private:
+    QPointer<RoiBatchLayer> m_layer;
+    int m_id;
+    RoiRecord m_before;
+    RoiRecord m_after;
+    bool m_applied;     //压栈时层中已是编辑后的记录，第一次redo跳过
+};
+
+/**
+ * @brief The RoiUndoRecorder class
+ * 监听登记图形的ROITransformStarted/ROITransformFinished，按下时记下几何，释放时与当前几何比较，
+ * 有变化才压入一条RoiEditCommand，拖动过程中的大量ROIChanged不产生命令。
+ * 大批量ROI层的编辑在写回层时由roiEdited压入RoiBatchEditCommand。
+ * 栈深度有上限，超过后最早的命令被丢弃，长时间使用内存不会增长
+ */
+class RoiUndoRecorder :public QObject
+{
+    Q_OBJECT
+public:
+    enum {DEFAULT_UNDO_LIMIT =500};
+
+    explicit RoiUndoRecorder(QObject *parent =nullptr);
+
+    QUndoStack* undoStack()  { return &m_stack;}
+    void setUndoLimit(int limit);
+    void addItem(QGraphicsObject *item);
+    void removeItem(QGraphicsObject *item);
+    void addLayer(RoiBatchLayer *layer);
+    void pushEdit(QGraphicsObject *item, const RoiRecord &before);
+
+    static bool applyRecord(QGraphicsObject *item, const RoiRecord &record);
+private:
+    QUndoStack m_stack;
+    QHash<QGraphicsObject*, RoiRecord> m_pending;   //正在操作的图形及其操作前的几何
+private slots:
+    void beginGesture();
+    void endGesture();
+};
+
+#endif // ROIUNDO_H
@@ -0,0 +1,1121 @@
+#include "simpleroi.h"
+
+#include <cmath>
+#include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QCursor>
+#include <QDebug>
+
+#define SHAPE_THICK 1 // 形状厚度
+#define ROIRECT_SIZE 6 //ROI方形大小
+#define SHAPE_CONTROL_THICK 1 //形状控制块厚度
+#define SHAPE_CONTROL_SIZE 5 //形状控制块
+#define SHAPE_RECT_MINLENGTH  18 //主矩形最小边长
+#define ROI_TWO_POINT // ROI两点控制
+#define DRAW_EIGHT_POINT   //ROI八点控制
+#define SIMPLE_POINT_WIDTH 12    //点图形标识线长度
+
+const double Pi =3.14159265;
+const double g_minLen =20;
+const double g_minAngle =5;
+
+//auxiliary functions
+void addElementWithText(QDomDocument *document, QDomElement *parent, const QString &tagName, const QString &data);
+void addHitShape(std::vector<RoiHitShape> &shapes, RoiHitShape::ShapeType type, int region, qreal radius,
+                 const QPointF *points, int count);
+bool pressRegion(QGraphicsObject *item, const QPointF &scenePos, int outside, int &region);
+
+
+//class SimpleROI
+
+SimpleROI::SimpleROI()
+{
+    m_shape.rect =QRectF(0, 0, 100, 100);
+    m_subPixel =false;
+    m_curRegion =SIMPLEROI_OUTSIDE;
+    m_bMove =m_bScale =false;
+    m_startPos =QPointF();
+    setCursor(Qt::ArrowCursor);
+    setFlag(QGraphicsItem::ItemIsMovable);
+    setFlag(QGraphicsItem::ItemIsSelectable);
+}
+
+SimpleROI::~SimpleROI()
+{
+
+}
+
+
+/**
+ * @brief SimpleROI::getRect
+ * 获取ROI矩形，亚像素模式下各边取整
+ * @return
+ */
+QRect SimpleROI::getRect() const
+{
+    return QRect(QPoint(qRound(m_shape.rect.left()), qRound(m_shape.rect.top())),
+                 QPoint(qRound(m_shape.rect.right()) -1, qRound(m_shape.rect.bottom()) -1));
+}
+
+/**
+ * @brief SimpleROI::hitShapes  四角方形控制点、四边和内部，覆盖judgePosition的全部命中范围
+ * @param shapes
+ */
+void SimpleROI::hitShapes(std::vector<RoiHitShape> &shapes) const
+{
+    QPointF corners[4] ={mapToScene(m_shape.rect.topLeft()), mapToScene(m_shape.rect.topRight()),
+                         mapToScene(m_shape.rect.bottomRight()), mapToScene(m_shape.rect.bottomLeft())};
+    const SimpleROIRegion cornerRegions[4] ={SIMPLEROI_TOPLEFT, SIMPLEROI_TOPRIGHT, SIMPLEROI_BOTTOMRIGHT, SIMPLEROI_BOTTOMLEFT};
+    const SimpleROIRegion edgeRegions[4] ={SIMPLEROI_TOP, SIMPLEROI_RIGHT, SIMPLEROI_BOTTOM, SIMPLEROI_LEFT};
+    for(int i =0; i <4; i++){
+        QPointF edge[2] ={corners[i], corners[(i +1) %4]};
+        addHitShape(shapes, RoiHitShape::HIT_BOX, cornerRegions[i], SHAPE_CONTROL_SIZE, &corners[i], 1);
+        addHitShape(shapes, RoiHitShape::HIT_EDGE, edgeRegions[i], SHAPE_CONTROL_SIZE, edge, 2);
+    }
+    addHitShape(shapes, RoiHitShape::HIT_AREA, SIMPLEROI_INSIDE, 0, corners, 4);
+}
+
+/**
+ * @brief SimpleROI::hitRegion  与按下时的judgePosition相同的区域判定
+ * @param scenePos
+ * @param type  角为方形控制点，其余为边或内部
+ * @param region
+ * @return  是否命中
+ */
+bool SimpleROI::hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const
+{
+    region =m_shape.hitTest(mapFromScene(scenePos), SHAPE_CONTROL_SIZE);
+    if(region ==SIMPLEROI_OUTSIDE)  return false;
+    if(region >=SIMPLEROI_TOPLEFT)  type =RoiHitShape::HIT_BOX;
+    else if(region ==SIMPLEROI_INSIDE)  type =RoiHitShape::HIT_AREA;
+    else  type =RoiHitShape::HIT_EDGE;
+    return true;
+}
+
+/**
+ * @brief SimpleROI::setRect  设置ROI矩形(图形坐标)
+ * @param rect
+ */
+void SimpleROI::setRect(const QRect &rect)
+{
+    setRectF(QRectF(rect));
+}
+
+/**
+ * @brief SimpleROI::setRectF  设置ROI矩形(图形坐标)，整像素模式下各边取整
+ * @param rect
+ */
+void SimpleROI::setRectF(const QRectF &rect)
+{
+    prepareGeometryChange();
+    m_shape.rect =QRectF(QPointF(snap(rect.left()), snap(rect.top())), QPointF(snap(rect.right()), snap(rect.bottom())));
+    update();
+    emit ROIChanged();
+}
+
+/**
+ * @brief SimpleROI::setSubPixel  切换亚像素模式，切回整像素时当前矩形各边取整
+ * @param enable
+ */
+void SimpleROI::setSubPixel(bool enable)
+{
+    if(m_subPixel ==enable)  return;
+    m_subPixel =enable;
+    if(!m_subPixel)  setRectF(m_shape.rect);
+}
+
+QRectF SimpleROI::boundingRect() const
+{
+    QPointF origin(m_shape.rect.x() -SHAPE_CONTROL_SIZE -1, m_shape.rect.y() -SHAPE_CONTROL_SIZE -1);
+    QSizeF size(m_shape.rect.width() +2*SHAPE_CONTROL_SIZE +2, m_shape.rect.height() +2*SHAPE_CONTROL_SIZE +2);
+    return QRectF(origin, size);
+}
+
+/**
+ * @brief SimpleROI::save
+ * 保存ROI，格式与RoiRecipe::writeXmlRecord一致：几何按17位有效数字写出，亚像素模式写subPixel属性
+ * @param document
+ * @param parent
+ */
+void SimpleROI::save(QDomDocument *document, QDomElement *parent)
+{
+    if(m_subPixel)
+        parent->setAttribute("subPixel", "1");
+    addElementWithText(document, parent, "x", QString::number(m_shape.rect.x(), 'g', 17));
+    addElementWithText(document, parent, "y", QString::number(m_shape.rect.y(), 'g', 17));
+    addElementWithText(document, parent, "width", QString::number(m_shape.rect.width(), 'g', 17));
+    addElementWithText(document, parent, "height", QString::number(m_shape.rect.height(), 'g', 17));
+}
+
+/**
+ * @brief SimpleROI::load
+ * 打开保存文件时加载ROI，按标签名读取x、y、width、height，顺序不限，缺少的字段保持原值；
+ * subPixel属性为1时恢复亚像素模式，否则为整像素模式
+ * @param source
+ */
+void SimpleROI::load(const QDomNode &source)
+{
+    m_subPixel =source.toElement().attribute("subPixel") ==QLatin1String("1");
+    qreal values[4] ={m_shape.rect.x(), m_shape.rect.y(), m_shape.rect.width(), m_shape.rect.height()};
+    const char *tags[4] ={"x", "y", "width", "height"};
+    for(QDomElement elem =source.firstChildElement(); !elem.isNull(); elem =elem.nextSiblingElement()){
+        for(int i =0; i <4; i++){
+            if(elem.tagName() ==QLatin1String(tags[i]))
+                values[i] =elem.text().toDouble();
+        }
+    }
+    setRectF(QRectF(values[0], values[1], values[2], values[3]));
+}
+
+/**
+ * @brief SimpleROI::toRecord  转换为配方记录
+ * @return
+ */
+RoiRecord SimpleROI::toRecord() const
+{
+    RoiRecord record =m_shape.toRecord();
+    record.flags =m_subPixel ? RoiRecord::FLAG_SUBPIXEL : 0;
+    return record;
+}
+
+/**
+ * @brief SimpleROI::fromRecord  从配方记录恢复，类型不符时不做改动
+ * @param record
+ * @return
+ */
+bool SimpleROI::fromRecord(const RoiRecord &record)
+{
+    RoiRectShape shape;
+    if(!RoiRectShape::fromRecord(record, shape))  return false;
+    m_subPixel =record.flags &RoiRecord::FLAG_SUBPIXEL;
+    setRectF(shape.rect);
+    return true;
+}
+
+/**
+ * @brief SimpleROI::writeXml  流式写出一个SimpleROI元素
+ * @param writer
+ */
+void SimpleROI::writeXml(QXmlStreamWriter &writer) const
+{
+    RoiRecipe::writeXmlRecord(writer, toRecord());
+}
+
+/**
+ * @brief SimpleROI::readXml
+ * 从reader当前的StartElement读取，子元素顺序不限；元素类型不符时跳过该元素，不做改动
+ * @param reader
+ * @return
+ */
+bool SimpleROI::readXml(QXmlStreamReader &reader)
+{
+    RoiRecord record;
+    if(!RoiRecipe::readXmlRecord(reader, record)){
+        reader.skipCurrentElement();
+        return false;
+    }
+    return fromRecord(record);
+}
+
+/**
+ * @brief CaliperTool::mousePressEvent
+ * 根据鼠标按下位置，确定变换类型
+ * @param event
+ */
+void SimpleROI::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->button() ==Qt::LeftButton){
+        m_startPos =event->pos();
+        int region;
+        if(pressRegion(this, event->scenePos(), SIMPLEROI_OUTSIDE, region))
+            m_curRegion =SimpleROIRegion(region);
+        else
+            m_curRegion =judgePosition(event->pos());
+        if(m_curRegion ==SIMPLEROI_OUTSIDE){
+            event->ignore();
+            return;
+        }
+        emit ROITransformStarted();
+        if(m_curRegion ==SIMPLEROI_INSIDE){
+            setCursor(Qt::ClosedHandCursor);
+            m_bMove =true;
+        }
+        else{
+            switch (m_curRegion) {
+            case SIMPLEROI_TOP:
+            case SIMPLEROI_BOTTOM:
+                setCursor(Qt::SizeVerCursor);
+                break;
+            case SIMPLEROI_LEFT:
+            case SIMPLEROI_RIGHT:
+                setCursor(Qt::SizeHorCursor);
+                break;
+            case SIMPLEROI_TOPLEFT:
+            case SIMPLEROI_BOTTOMRIGHT:
+                setCursor(Qt::SizeFDiagCursor);
+                break;
+            case SIMPLEROI_TOPRIGHT:
+            case SIMPLEROI_BOTTOMLEFT:
+                setCursor(Qt::SizeBDiagCursor);
+                break;
+            default:
+                break;
+            }
+            m_bScale =true;
+        }
+    }
+}
+
+/**
+ * @brief CaliperTool::mouseMoveEvent
+ * 鼠标按下并移动时进行变换
+ * @param event
+ */
+void SimpleROI::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->buttons() &Qt::LeftButton){
+        if(m_bMove){
+            setCursor(Qt::ClosedHandCursor);
+            moveShape(event->pos());
+        }
+        else if(m_bScale){
+            scaleROI(event->pos());
+        }
+    }
+}
+
+/**
+ * @brief CaliperTool::mouseReleaseEvent
+ * 鼠标释放，一次变换完成
+ * @param event
+ */
+void SimpleROI::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    setCursor(Qt::ArrowCursor);
+    QGraphicsObject::mouseReleaseEvent(event);
+    m_startPos = QPointF();
+    m_curRegion =SIMPLEROI_OUTSIDE;
+    m_bScale = false;
+    m_bMove = false;
+    emit ROITransformFinished();
+}
+
+/**
+ * @brief SimpleROI::judgePosition
+ * 判断pos位于ROI的区域
+ * @param pos
+ * @return
+ */
+SimpleROI::SimpleROIRegion SimpleROI::judgePosition(const QPointF &pos)
+{
+    return SimpleROIRegion(m_shape.hitTest(pos, SHAPE_CONTROL_SIZE));
+}
+
+/**
+ * @brief SimpleROI::scaleROI
+ * 根据拖动位置对ROI进行缩放
+ * @param mousePoint
+ */
+void SimpleROI::scaleROI(const QPointF &mousePoint)
+{
+    QPointF cur(snap(mousePoint.x()), snap(mousePoint.y()));
+    prepareGeometryChange();
+    m_shape.dragHandle(RoiRectShape::Region(m_curRegion), cur, SHAPE_RECT_MINLENGTH);
+    update();
+    emit ROIChanged();
+}
+
+/**
+ * @brief SimpleROI::moveShape
+ * 拖动鼠标对ROI进行平移
+ * @param mousePoint
+ */
+void SimpleROI::moveShape(const QPointF &mousePoint)
+{
+    prepareGeometryChange();
+    QPointF distance =mousePoint -m_startPos;
+    m_shape.translate(snap(distance.x()), snap(distance.y()));
+    m_startPos =mousePoint;
+    update();
+    emit ROIChanged();
+}
+
+void SimpleROI::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    QPen pen(Qt::darkBlue);
+    pen.setWidth(SHAPE_THICK);
+    painter->setPen(pen);
+    painter->drawRect(m_shape.rect);
+
+#ifdef DRAW_EIGHT_POINT
+    painter->setBrush(Qt::red);
+    pen.setColor(Qt::darkRed);
+    pen.setWidthF(0.1 *SHAPE_THICK);
+    painter->setPen(pen);
+    QPointF dx(m_subPixel ? m_shape.rect.width() /2 : int(m_shape.rect.width()) /2, 0);
+    QPointF dy(0, m_subPixel ? m_shape.rect.height() /2 : int(m_shape.rect.height()) /2);
+    QPointF topR =m_shape.rect.topRight();
+    QPointF bottomL =m_shape.rect.bottomLeft();
+    QPointF bottomR =m_shape.rect.bottomRight();
+    QVector<QPointF> centers;
+    centers <<m_shape.rect.topLeft() <<m_shape.rect.topLeft() +dx <<topR
+           <<m_shape.rect.topLeft() +dy <<topR +dy
+          <<bottomL <<bottomL +dx <<bottomR;
+    QPointF offset(ROIRECT_SIZE /2, ROIRECT_SIZE /2);
+    for(int i =0; i <centers.size(); ++i){
+        QRectF little(centers[i] -offset, centers[i] +offset);
+        painter->drawRect(little);
+    }
+#endif
+}
+
+
+
+//class CaliperTool
+
+CaliperTool::CaliperTool()
+{
+    m_curRegion =CALIPER_NONE;
+    m_bMove =m_bScale =m_bRotate =m_bShear =false;
+    m_startPos =QPointF(0, 0);
+    m_shape =RoiCaliperShape(QPointF(80, 20), 160, 40, 0, 0);
+    m_quadDirty =true;
+    setFlag(QGraphicsItem::ItemIsMovable);
+    setFlag(QGraphicsItem::ItemIsSelectable);
+}
+
+CaliperTool::~CaliperTool()
+{
+
+}
+
+QRectF CaliperTool::boundingRect() const
+{
+    QRectF rect =quadBounds(quad());
+    QPointF origin(rect.x() -SHAPE_CONTROL_SIZE, rect.y() -SHAPE_CONTROL_SIZE);
+    QSizeF size(rect.width() +2 *SHAPE_CONTROL_SIZE +2, rect.height() +2 *SHAPE_CONTROL_SIZE +2);
+    return QRectF(origin, size);
+}
+
+/**
+ * @brief CaliperTool::reInitialize  重新初始化，只针对旋转和倾斜
+ */
+void CaliperTool::reInitialize()
+{
+    if(m_shape.angle ==0 && m_shape.shearAngle ==0)  return;
+    prepareGeometryChange();
+    m_shape.angle =0;
+    m_shape.shearAngle =0;
+    shapeChanged();
+}
+
+/**
+ * @brief CaliperTool::setShape  按参数设置卡尺(图形坐标)
+ * @param centre
+ * @param width  上边长
+ * @param height  左边长
+ * @param angle  旋转角(弧度)
+ * @param shearAngle  倾斜角(弧度)
+ */
+void CaliperTool::setShape(const QPointF &centre, qreal width, qreal height, qreal angle, qreal shearAngle)
+{
+    prepareGeometryChange();
+    m_shape =RoiCaliperShape(centre, width, height, angle, shearAngle);
+    shapeChanged();
+    emit ROIChanged();
+}
+
+/**
+ * @brief CaliperTool::vertexes  返回卡尺ROI四个顶点
+ * @return
+ */
+std::vector<QPointF> CaliperTool::vertexes() const
+{
+    const RoiQuad &shape =quad();
+    return std::vector<QPointF>(shape.begin(), shape.begin() +4);
+}
+
+/**
+ * @brief CaliperTool::geometry  场景(图像)坐标下的卡尺几何，用于批量测量
+ * @return
+ */
+CaliperGeometry CaliperTool::geometry() const
+{
+    CaliperGeometry geom;
+    const RoiQuad &shape =quad();
+    for(int i =0; i <4; i++)
+        geom.vertexes[i] =mapToScene(shape[i]);
+    geom.angle =m_shape.angle;
+    geom.shearAngle =m_shape.shearAngle;
+    return geom;
+}
+
+/**
+ * @brief CaliperTool::hitShapes  旋转、倾斜控制点，四角和四边，覆盖judgePosition的全部命中范围
+ * @param shapes
+ */
+void CaliperTool::hitShapes(std::vector<RoiHitShape> &shapes) const
+{
+    QPointF pts[4];
+    const RoiQuad &shape =quad();
+    for(int i =0; i <4; i++)
+        pts[i] =mapToScene(shape[i]);
+    QPointF rmid =(pts[1] +pts[2]) /2, bmid =(pts[2] +pts[3]) /2;
+    addHitShape(shapes, RoiHitShape::HIT_HANDLE, CALIPER_RIGHTMIDDLE, SHAPE_CONTROL_SIZE, &rmid, 1);
+    addHitShape(shapes, RoiHitShape::HIT_HANDLE, CALIPER_BOTTOMMIDDLE, SHAPE_CONTROL_SIZE, &bmid, 1);
+    for(int i =0; i <4; i++){
+        QPointF edge[2] ={pts[i], pts[(i +1) %4]};
+        addHitShape(shapes, RoiHitShape::HIT_HANDLE, CALIPER_TOPLEFT +i, SHAPE_CONTROL_SIZE, &pts[i], 1);
+        addHitShape(shapes, RoiHitShape::HIT_EDGE, CALIPER_TOP +i, SHAPE_CONTROL_SIZE, edge, 2);
+    }
+}
+
+/**
+ * @brief CaliperTool::hitRegion  与按下时的judgePosition相同的区域判定
+ * @param scenePos
+ * @param type
+ * @param region
+ * @return  是否命中
+ */
+bool CaliperTool::hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const
+{
+    region =judgePosition(mapFromScene(scenePos));
+    if(region ==CALIPER_NONE)  return false;
+    type =region <=CALIPER_BOTTOMMIDDLE ? RoiHitShape::HIT_HANDLE : RoiHitShape::HIT_EDGE;
+    return true;
+}
+
+/**
+ * @brief CaliperTool::setGeometry
+ * 按场景坐标的顶点、旋转角和倾斜角设置卡尺，图形位置复位到原点；中心和边长由顶点得到
+ * @param geometry
+ */
+void CaliperTool::setGeometry(const CaliperGeometry &geometry)
+{
+    RoiCaliperShape shape =RoiCaliperShape::fromVertexes(geometry.vertexes, geometry.angle, geometry.shearAngle);
+    setPos(0, 0);
+    setShape(shape.centre, shape.width, shape.height, shape.angle, shape.shearAngle);
+}
+
+/**
+ * @brief CaliperTool::toRecord  转换为配方记录，直接保存几何参数
+ * @return
+ */
+RoiRecord CaliperTool::toRecord() const
+{
+    return m_shape.toRecord();
+}
+
+/**
+ * @brief CaliperTool::fromRecord  从配方记录恢复，类型不符时不做改动
+ * @param record
+ * @return
+ */
+bool CaliperTool::fromRecord(const RoiRecord &record)
+{
+    RoiCaliperShape shape;
+    if(!RoiCaliperShape::fromRecord(record, shape))  return false;
+    setShape(shape.centre, shape.width, shape.height, shape.angle, shape.shearAngle);
+    return true;
+}
+
+/**
+ * @brief CaliperTool::writeXml  流式写出一个CaliperTool元素
+ * @param writer
+ */
+void CaliperTool::writeXml(QXmlStreamWriter &writer) const
+{
+    RoiRecipe::writeXmlRecord(writer, toRecord());
+}
+
+/**
+ * @brief CaliperTool::readXml
+ * 从reader当前的StartElement读取，子元素顺序不限；元素类型不符时跳过该元素，不做改动
+ * @param reader
+ * @return
+ */
+bool CaliperTool::readXml(QXmlStreamReader &reader)
+{
+    RoiRecord record;
+    if(!RoiRecipe::readXmlRecord(reader, record)){
+        reader.skipCurrentElement();
+        return false;
+    }
+    return fromRecord(record);
+}
+
+/**
+ * @brief CaliperTool::setCaliperParams  设置卡尺测量参数
+ * @param params
+ */
+void CaliperTool::setCaliperParams(const CaliperParams &params)
+{
+    m_engine.setParams(params);
+}
+
+/**
+ * @brief CaliperTool::measure
+ * 在image上进行卡尺测量，顶点映射到场景(图像)坐标；形状未变化时复用采样网格
+ * @param image  CV_8UC1或CV_16UC1
+ * @param result
+ * @return
+ */
+bool CaliperTool::measure(const cv::Mat &image, CaliperResult &result)
+{
+    std::vector<QPointF> vec =vertexes();
+    for(QPointF &pt :vec)
+        pt =mapToScene(pt);
+    m_engine.setGeometry(vec);
+    return m_engine.measure(image, result);
+}
+
+/**
+ * @brief CaliperTool::extractPatch
+ * 提取卡尺区域并校正为矩形，仿射变换由顶点、m_angle和m_shearAngle确定；
+ * 重映射表在形状变化前一直复用。返回的Mat与内部缓冲共享，下一次提取会覆盖其内容，需要保留时请clone()
+ * @param image
+ * @return
+ */
+cv::Mat CaliperTool::extractPatch(const cv::Mat &image)
+{
+    m_extractor.setGeometry(geometry());
+    if(!m_extractor.extract(image, m_patch))
+        return cv::Mat();
+    return m_patch;
+}
+
+/**
+ * @brief CaliperTool::mousePressEvent
+ * 根据鼠标按下位置，确定变换类型
+ * @param event
+ */
+void CaliperTool::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->button() ==Qt::LeftButton){
+        m_startPos =event->pos();
+        int region;
+        if(pressRegion(this, event->scenePos(), CALIPER_NONE, region))
+            m_curRegion =CaliperRegion(region);
+        else
+            m_curRegion =judgePosition(event->pos());
+        switch (m_curRegion) {
+        case CALIPER_TOPLEFT:
+        case CALIPER_TOPRIGHT:
+        case CALIPER_BOTTOMRIGHT:
+        case CALIPER_BOTTOMLEFT:
+            setCursor(Qt::CrossCursor);
+            m_bScale =true;
+            break;
+        case CALIPER_RIGHTMIDDLE:
+            setCursor(Qt::PointingHandCursor);
+            m_bRotate =true;
+            break;
+        case CALIPER_BOTTOMMIDDLE:
+            setCursor(Qt::PointingHandCursor);
+            m_bShear =true;
+            break;
+        case CALIPER_TOP:
+        case CALIPER_RIGHT:
+        case CALIPER_BOTTOM:
+        case CALIPER_LEFT:
+            setCursor(Qt::SizeAllCursor);
+            m_bMove =true;
+            break;
+        default:
+            event->ignore();
+            return;
+        }
+        emit ROITransformStarted();
+    }
+}
+
+
+/**
+ * @brief CaliperTool::mouseMoveEvent
+ * 鼠标按下并移动时进行变换
+ * @param event
+ */
+void CaliperTool::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->buttons() & Qt::LeftButton){
+        QPointF mousePos =event->pos();
+        if(m_bMove){
+            setCursor(Qt::ClosedHandCursor);
+            move(mousePos);
+        }
+        else if(m_bScale){
+            scale(mousePos);
+        }
+        else if(m_bRotate){
+            rotate(mousePos);
+        }
+        else if(m_bShear)
+        {
+            shear(mousePos);
+        }
+        else
+            return;
+        emit ROIChanged();
+    }
+}
+
+/**
+ * @brief CaliperTool::mouseReleaseEvent
+ * 鼠标释放，一次变换完成
+ * @param event
+ */
+void CaliperTool::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    setCursor(Qt::ArrowCursor);
+    QGraphicsObject::mouseReleaseEvent(event);
+    m_curRegion =CALIPER_NONE;
+    m_bMove =m_bScale =m_bRotate =m_bShear =false;
+    emit ROITransformFinished();
+}
+
+/**
+ * @brief CaliperTool::paint  绘制卡尺ROI
+ * @param painter
+ * @param option
+ * @param widget
+ */
+void CaliperTool::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    int ctrlLen =SHAPE_CONTROL_SIZE -1;
+
+    QPen pen(Qt::blue);
+    pen.setWidthF(0.5);
+    painter->setPen(pen);
+    painter->setRenderHint(QPainter::Antialiasing);
+    const RoiQuad &shape =quad();
+    painter->drawPolygon(shape.data(), 4);
+
+    pen.setColor(QColor(102, 204, 102));
+    painter->setPen(pen);
+    QPointF rmid =(shape[1] +shape[2]) /2;
+    QPointF bmid =(shape[2] +shape[3]) /2;
+    QPointF tmid =(shape[0] +shape[1]) /2;
+    QPointF lmid =(shape[3] +shape[0]) /2;
+    QPointF arrowPt(rmid.x(), rmid.y() +ctrlLen);
+    QPointF ass1(tmid.x() -3, tmid.y() -2);
+    QPointF ass2(tmid.x() -3, tmid.y() +2);
+    QPointF ass3(lmid.x() -2, lmid.y() -3);
+    QPointF ass4(lmid.x() +2, lmid.y() -3);
+    SinCos rot(m_shape.angle), edgeRot(m_shape.angle +m_shape.shearAngle);
+    QVector<QLineF> lines;
+    lines <<QLineF(arrowPt, QPointF(arrowPt.x() +1, arrowPt.y() -2))
+          <<QLineF(arrowPt, QPointF(arrowPt.x() +2, arrowPt.y() +1))
+          <<QLineF(tmid, rotatePoint(ass1, tmid, rot))
+          <<QLineF(tmid, rotatePoint(ass2, tmid, rot))
+          <<QLineF(lmid, rotatePoint(ass3, lmid, edgeRot))
+          <<QLineF(lmid, rotatePoint(ass4, lmid, edgeRot));
+    painter->drawLines(lines);
+    painter->drawArc(qRound(rmid.x() -ctrlLen), qRound(rmid.y() -ctrlLen),
+                     2 *ctrlLen, 2 *ctrlLen, 270 *16, 270 *16);
+    QVector<QPointF> vec1;
+    QPointF offset1(ctrlLen /2, 0);
+    vec1 <<QPointF(bmid.x() -ctrlLen, bmid.y() -ctrlLen) +offset1
+         <<QPointF(bmid.x() +ctrlLen, bmid.y() -ctrlLen) +offset1
+         <<QPointF(bmid.x() +ctrlLen, bmid.y() +ctrlLen) -offset1
+         <<QPointF(bmid.x() -ctrlLen, bmid.y() +ctrlLen) -offset1
+         <<QPointF(bmid.x() -ctrlLen, bmid.y() -ctrlLen) +offset1;
+    painter->drawPolygon(QPolygonF(vec1));
+}
+
+/**
+ * @brief CaliperTool::judgePosition
+ * 判断点在ROI哪个位置，区域编号与RoiCaliperShape一致
+ * @param pos
+ * @return
+ */
+CaliperTool::CaliperRegion CaliperTool::judgePosition(const QPointF &pos) const
+{
+    return CaliperRegion(RoiCaliperShape::hitTest(quad(), pos, SHAPE_CONTROL_SIZE));
+}
+
+/**
+ * @brief CaliperTool::quad
+ * 由参数计算的闭合顶点：中心 +旋转∘倾斜(±宽/2, ±高/2)，参数变化后第一次访问时重算
+ * @return
+ */
+const RoiQuad& CaliperTool::quad() const
+{
+    if(m_quadDirty){
+        m_shape.quad(m_quad);
+        m_quadDirty =false;
+    }
+    return m_quad;
+}
+
+/**
+ * @brief CaliperTool::shapeChanged  参数已修改，作废顶点缓存并重绘；调用前需prepareGeometryChange()
+ */
+void CaliperTool::shapeChanged()
+{
+    m_quadDirty =true;
+    update();
+}
+
+/**
+ * @brief CaliperTool::move  移动
+ * @param pos
+ */
+void CaliperTool::move(const QPointF &pos)
+{
+    prepareGeometryChange();
+    m_shape.translate(pos -m_startPos);
+    m_startPos =pos;
+    shapeChanged();
+}
+
+/**
+ * @brief CaliperTool::scale  拖动角点缩放，对角顶点不动，宽高分别不小于g_minLen和g_minLen/2
+ * @param pos
+ */
+void CaliperTool::scale(const QPointF &pos)
+{
+    int corner =m_curRegion -CALIPER_TOPLEFT;
+    if(corner <0 || corner >3)  return;
+    prepareGeometryChange();
+    m_shape.dragCorner(corner, pos, g_minLen, g_minLen /2);
+    m_startPos =pos;
+    shapeChanged();
+}
+
+/**
+ * @brief CaliperTool::rotate  旋转，绕中心转到鼠标方向
+ * @param pos
+ */
+void CaliperTool::rotate(const QPointF &pos)
+{
+    prepareGeometryChange();
+    m_shape.rotateTowards(pos);
+    shapeChanged();
+}
+
+/**
+ * @brief CaliperTool::shear  倾斜：左右两边绕各自中点转向鼠标，要求左边向下且倾斜不超过90°-g_minAngle
+ * @param pos
+ */
+void CaliperTool::shear(const QPointF &pos)
+{
+    RoiCaliperShape sheared =m_shape;
+    if(sheared.shearTowards(pos, std::sin(g_minAngle *Pi /180))){
+        prepareGeometryChange();
+        m_shape =sheared;
+        shapeChanged();
+    }
+}
+
+
+
+//class SimpleMovablePoint
+
+SimpleMovablePoint::SimpleMovablePoint()
+{
+    m_point =QPoint(20, 20);
+    m_isMoving =false;
+}
+
+SimpleMovablePoint::~SimpleMovablePoint()
+{
+
+}
+
+QRectF SimpleMovablePoint::boundingRect() const
+{
+    QPointF origin =m_point -QPointF(SIMPLE_POINT_WIDTH +1, SIMPLE_POINT_WIDTH +1);
+    return QRectF(origin, QSize(SIMPLE_POINT_WIDTH +1, SIMPLE_POINT_WIDTH +1) *2);
+}
+
+/**
+ * @brief SimpleMovablePoint::hitShapes  点的操作范围
+ * @param shapes
+ */
+void SimpleMovablePoint::hitShapes(std::vector<RoiHitShape> &shapes) const
+{
+    QPointF center =mapToScene(QPointF(m_point));
+    addHitShape(shapes, RoiHitShape::HIT_BOX, 0, SIMPLE_POINT_WIDTH /2, &center, 1);
+}
+
+/**
+ * @brief SimpleMovablePoint::hitRegion  与按下时相同的方框判定
+ * @param scenePos
+ * @param type
+ * @param region
+ * @return  是否命中
+ */
+bool SimpleMovablePoint::hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const
+{
+    if(!RoiPointShape(m_point).hitTest(mapFromScene(scenePos), SIMPLE_POINT_WIDTH /2))  return false;
+    type =RoiHitShape::HIT_BOX;
+    region =0;
+    return true;
+}
+
+/**
+ * @brief SimpleMovablePoint::positionOnScene  坐标转换到Scene坐标系
+ * @return
+ */
+QPoint SimpleMovablePoint::positionOnScene() const
+{
+    return mapToScene(m_point).toPoint();
+}
+
+/**
+ * @brief SimpleMovablePoint::moveTo  移动
+ * @param x
+ * @param y
+ */
+void SimpleMovablePoint::moveTo(int x, int y)
+{
+    moveShape(QPointF(x, y));
+}
+
+/**
+ * @brief SimpleMovablePoint::toRecord  转换为配方记录(图形坐标)
+ * @return
+ */
+RoiRecord SimpleMovablePoint::toRecord() const
+{
+    return RoiPointShape(m_point).toRecord();
+}
+
+/**
+ * @brief SimpleMovablePoint::fromRecord  从配方记录恢复，类型不符时不做改动
+ * @param record
+ * @return
+ */
+bool SimpleMovablePoint::fromRecord(const RoiRecord &record)
+{
+    RoiPointShape shape;
+    if(!RoiPointShape::fromRecord(record, shape))  return false;
+    moveShape(shape.pos);
+    return true;
+}
+
+/**
+ * @brief SimpleMovablePoint::writeXml  流式写出一个SimpleMovablePoint元素
+ * @param writer
+ */
+void SimpleMovablePoint::writeXml(QXmlStreamWriter &writer) const
+{
+    RoiRecipe::writeXmlRecord(writer, toRecord());
+}
+
+/**
+ * @brief SimpleMovablePoint::readXml
+ * 从reader当前的StartElement读取，子元素顺序不限；元素类型不符时跳过该元素，不做改动
+ * @param reader
+ * @return
+ */
+bool SimpleMovablePoint::readXml(QXmlStreamReader &reader)
+{
+    RoiRecord record;
+    if(!RoiRecipe::readXmlRecord(reader, record)){
+        reader.skipCurrentElement();
+        return false;
+    }
+    return fromRecord(record);
+}
+
+/**
+ * @brief SimpleMovablePoint::mousePressEvent  鼠标按下判断是否进入操作范围
+ * @param event
+ */
+void SimpleMovablePoint::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->buttons() & Qt::LeftButton){
+        int region;
+        bool hit;
+        if(pressRegion(this, event->scenePos(), -1, region))
+            hit =region >=0;
+        else
+            hit =RoiPointShape(m_point).hitTest(event->pos(), SIMPLE_POINT_WIDTH/2);
+        if(hit){
+            m_isMoving =true;
+            setCursor(Qt::CrossCursor);
+            emit ROITransformStarted();
+        }
+        else{
+            event->ignore();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief SimpleMovablePoint::mouseMoveEvent  鼠标按下时移动，进行变换
+ * @param event
+ */
+void SimpleMovablePoint::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    if(event->buttons() & Qt::LeftButton){
+        if(m_isMoving){
+            moveShape(event->pos());
+        }
+    }
+}
+
+/**
+ * @brief SimpleMovablePoint::mouseReleaseEvent  鼠标释放，变换完成
+ * @param event
+ */
+void SimpleMovablePoint::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    QGraphicsObject::mouseReleaseEvent(event);
+    setCursor(Qt::ArrowCursor);
+    if(!m_isMoving)  return;
+    m_isMoving =false;
+    emit ROITransformFinished();
+}
+
+/**
+ * @brief SimpleMovablePoint::moveShape  移动实现
+ * @param pos
+ */
+void SimpleMovablePoint::moveShape(const QPointF &pos)
+{
+    prepareGeometryChange();
+    m_point =pos.toPoint();
+    emit positionChanged();
+    update();
+}
+
+/**
+ * @brief SimpleMovablePoint::paint
+ * 绘制点和标识线
+ * @param painter
+ * @param option
+ * @param widget
+ */
+void SimpleMovablePoint::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    QPen pen(QColor(0, 205, 0));
+    pen.setWidth(1);
+    painter->setPen(pen);
+    QPointF origin =m_point -QPointF(SIMPLE_POINT_WIDTH/2, SIMPLE_POINT_WIDTH/2);
+    QRectF rect(origin, QSize(SIMPLE_POINT_WIDTH, SIMPLE_POINT_WIDTH));
+    painter->drawRect(rect);
+
+    int x0 =m_point.x(), y0 =m_point.y();
+    QLine horline(QPoint(x0 -SIMPLE_POINT_WIDTH, y0), QPoint(x0 +SIMPLE_POINT_WIDTH, y0));
+    QLine verline(QPoint(x0, y0 -SIMPLE_POINT_WIDTH), QPoint(x0, y0 +SIMPLE_POINT_WIDTH));
+    painter->drawLine(horline);
+    painter->drawLine(verline);
+}
+
+
+
+// auxiliary functions
+
+/**
+ * @brief GlobalFuncs::addElementWithText XML工具，为parent添加一个子节点，该子节点包含一个text节点作为数据(参数data)
+ * @param document  文件指针
+ * @param parent  父节点
+ * @param tagName  子节点标签
+ * @param data  子节点text
+ */
+void addElementWithText(QDomDocument *document, QDomElement *parent, const QString &tagName, const QString &data)
+{
+    QDomElement elem =document->createElement(tagName);
+    QDomText text =document->createTextNode(data);
+    elem.appendChild(text);
+    parent->appendChild(elem);
+}
+
+/**
+ * @brief createRoiItem
+ * 按配方记录创建对应的交互图形，可作为RoiRecipe::readXml的回调在读到元素时立即创建
+ * @param record
+ * @return  未知类型返回nullptr，调用方负责加入场景
+ */
+QGraphicsObject* createRoiItem(const RoiRecord &record)
+{
+    switch (record.type) {
+    case RoiRecord::ROI_RECT:{
+        SimpleROI *roi =new SimpleROI;
+        roi->fromRecord(record);
+        return roi;
+    }
+    case RoiRecord::ROI_CALIPER:{
+        CaliperTool *caliper =new CaliperTool;
+        caliper->fromRecord(record);
+        return caliper;
+    }
+    case RoiRecord::ROI_POINT:{
+        SimpleMovablePoint *point =new SimpleMovablePoint;
+        point->fromRecord(record);
+        return point;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * @brief roiItemRecord  取交互图形当前的配方记录(图形坐标)，与createRoiItem对应
+ * @param item
+ * @param record  输出
+ * @return  不支持的图形类型返回false
+ */
+bool roiItemRecord(QGraphicsObject *item, RoiRecord &record)
+{
+    if(SimpleROI *roi =qobject_cast<SimpleROI*>(item))
+        record =roi->toRecord();
+    else if(CaliperTool *caliper =qobject_cast<CaliperTool*>(item))
+        record =caliper->toRecord();
+    else if(SimpleMovablePoint *point =qobject_cast<SimpleMovablePoint*>(item))
+        record =point->toRecord();
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief addHitShape  追加一个命中测试图元
+ * @param shapes
+ * @param type
+ * @param region
+ * @param radius
+ * @param points
+ * @param count  控制点1个，边2个，区域4个
+ */
+void addHitShape(std::vector<RoiHitShape> &shapes, RoiHitShape::ShapeType type, int region, qreal radius,
+                 const QPointF *points, int count)
+{
+    RoiHitShape shape;
+    shape.type =type;
+    shape.region =region;
+    shape.radius =radius;
+    for(int i =0; i <4; i++)
+        shape.points[i] =points[qMin(i, count -1)];
+    shapes.push_back(shape);
+}
+
+/**
+ * @brief pressRegion  按下位置属于item的哪个区域，由场景的RoiHitIndex统一判断
+ * 不是命中图形时为outside，图形忽略事件后交给光标下的下一个图形
+ * @param item
+ * @param scenePos
+ * @param outside
+ * @param region
+ * @return  item未登记到命中索引时返回false，由图形自己判断
+ */
+bool pressRegion(QGraphicsObject *item, const QPointF &scenePos, int outside, int &region)
+{
+    RoiHitIndex *index =RoiHitIndex::forScene(item->scene());
+    if(!index || !index->contains(item))  return false;
+    RoiHit hit =index->pressHit(scenePos);
+    region =hit.item ==item ? hit.region : outside;
+    return true;
+}
@@ -0,0 +1,189 @@
+#ifndef SIMPLEROI_H
+#define SIMPLEROI_H
+
+/**
+可交互ROI图形，用于通过鼠标选取图像处理范围、卡尺测量、获取位置等功能
+**/
+
+#include <QGraphicsScene>
+#include <QGraphicsItem>
+#include <QPolygon>
+#include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include "caliper.h"
+#include "roihitindex.h"
+#include "roishapes.h"
+
+/**
+ * @brief The SimpleROI class
+ * 简单矩形ROI，交互功能只包含平移和缩放，使用简单。
+ * 默认整像素模式，坐标随鼠标取整；亚像素模式下保留浮点坐标，放大查看微小特征时不会整像素跳动
+ */
+class SimpleROI :public QGraphicsObject, public RoiHitTarget
+{
+    Q_OBJECT
+public:
+    SimpleROI();
+    ~SimpleROI();
+
+    QRect getRect() const;
+    QRectF getRectF() const  { return m_shape.rect;}
+    void setRect(const QRect &rect);
+    void setRectF(const QRectF &rect);
+    void setSubPixel(bool enable);
+    bool isSubPixel() const  { return m_subPixel;}
+    QRectF boundingRect() const override;
+    void hitShapes(std::vector<RoiHitShape> &shapes) const override;
+    bool hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const override;
+    void save(QDomDocument *document, QDomElement *parent);
+    void load(const QDomNode &source);
+    RoiRecord toRecord() const;
+    bool fromRecord(const RoiRecord &record);
+    void writeXml(QXmlStreamWriter &writer) const;
+    bool readXml(QXmlStreamReader &reader);
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+private:
+    enum SimpleROIRegion {SIMPLEROI_OUTSIDE =RoiRectShape::OUTSIDE,
+                         SIMPLEROI_INSIDE =RoiRectShape::INSIDE,
+                         SIMPLEROI_TOP =RoiRectShape::TOP, SIMPLEROI_RIGHT =RoiRectShape::RIGHT,
+                         SIMPLEROI_BOTTOM =RoiRectShape::BOTTOM, SIMPLEROI_LEFT =RoiRectShape::LEFT,
+                         SIMPLEROI_TOPLEFT =RoiRectShape::TOPLEFT, SIMPLEROI_TOPRIGHT =RoiRectShape::TOPRIGHT,
+                         SIMPLEROI_BOTTOMRIGHT =RoiRectShape::BOTTOMRIGHT, SIMPLEROI_BOTTOMLEFT =RoiRectShape::BOTTOMLEFT};
+    RoiRectShape m_shape;
+    bool m_subPixel;
+    SimpleROIRegion m_curRegion;
+    QPointF m_startPos;
+    bool m_bMove;
+    bool m_bScale;
+
+    SimpleROIRegion judgePosition(const QPointF &pos);
+    qreal snap(qreal value) const  { return m_subPixel ? value : qRound(value);}
+
+    void scaleROI(const QPointF &mousePoint);
+    void moveShape(const QPointF &mousePoint);
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+signals:
+    void ROIChanged();
+    void ROITransformStarted();
+    void ROITransformFinished();
+};
+
+
+/**
+ * @brief The CaliperTool class
+ * 旋转矩形ROI，交互功能包括平移、旋转、缩放、倾斜，同时可用于卡尺测量。
+ * 几何以参数(中心、宽、高、旋转角、倾斜角)保存，顶点按需计算并缓存
+ */
+class CaliperTool :public QGraphicsObject, public RoiHitTarget
+{
+    Q_OBJECT
+public:
+    CaliperTool();
+    ~CaliperTool();
+
+    QRectF boundingRect() const override;
+    void hitShapes(std::vector<RoiHitShape> &shapes) const override;
+    bool hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const override;
+    void reInitialize();
+    void setShape(const QPointF &centre, qreal width, qreal height, qreal angle, qreal shearAngle);
+    const RoiCaliperShape& caliperShape() const  { return m_shape;}
+    QPointF centre() const  { return m_shape.centre;}
+    qreal width() const  { return m_shape.width;}
+    qreal height() const  { return m_shape.height;}
+    qreal angle() const  { return m_shape.angle;}
+    qreal shearAngle() const  { return m_shape.shearAngle;}
+    std::vector<QPointF> vertexes() const;
+    CaliperGeometry geometry() const;
+    void setGeometry(const CaliperGeometry &geometry);
+    RoiRecord toRecord() const;
+    bool fromRecord(const RoiRecord &record);
+    void writeXml(QXmlStreamWriter &writer) const;
+    bool readXml(QXmlStreamReader &reader);
+    void setCaliperParams(const CaliperParams &params);
+    bool measure(const cv::Mat &image, CaliperResult &result);
+    cv::Mat extractPatch(const cv::Mat &image);
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+private:
+    enum CaliperRegion {CALIPER_NONE =RoiCaliperShape::NONE,
+                        CALIPER_TOPLEFT =RoiCaliperShape::TOPLEFT, CALIPER_TOPRIGHT =RoiCaliperShape::TOPRIGHT,
+                        CALIPER_BOTTOMRIGHT =RoiCaliperShape::BOTTOMRIGHT, CALIPER_BOTTOMLEFT =RoiCaliperShape::BOTTOMLEFT,
+                        CALIPER_RIGHTMIDDLE =RoiCaliperShape::RIGHTMIDDLE, CALIPER_BOTTOMMIDDLE =RoiCaliperShape::BOTTOMMIDDLE,
+                        CALIPER_TOP =RoiCaliperShape::TOP, CALIPER_RIGHT =RoiCaliperShape::RIGHT,
+                        CALIPER_BOTTOM =RoiCaliperShape::BOTTOM, CALIPER_LEFT =RoiCaliperShape::LEFT};
+    CaliperRegion m_curRegion;
+    RoiCaliperShape m_shape;
+    bool m_bMove;
+    bool m_bScale;
+    bool m_bRotate;
+    bool m_bShear;
+    QPointF m_startPos;
+    mutable RoiQuad m_quad;
+    mutable bool m_quadDirty;
+    CaliperEngine m_engine;
+    PatchExtractor m_extractor;
+    cv::Mat m_patch;
+
+    CaliperRegion judgePosition(const QPointF &pos) const;
+    const RoiQuad& quad() const;
+    void shapeChanged();
+    void move(const QPointF &pos);
+    void scale(const QPointF &pos);
+    void rotate(const QPointF &pos);
+    void shear(const QPointF &pos);
+signals:
+    void ROIChanged();
+    void ROITransformStarted();
+    void ROITransformFinished();
+};
+
+
+/**
+ * @brief The SimpleMovablePoint class
+ * 交互点图像，用于通过鼠标获取某位置
+ */
+class SimpleMovablePoint :public QGraphicsObject, public RoiHitTarget
+{
+    Q_OBJECT
+
+public:
+    SimpleMovablePoint();
+    ~SimpleMovablePoint();
+
+    QRectF boundingRect() const override;
+    void hitShapes(std::vector<RoiHitShape> &shapes) const override;
+    bool hitRegion(const QPointF &scenePos, RoiHitShape::ShapeType &type, int &region) const override;
+    QPoint positionOnScene() const;
+    void moveTo(int x, int y);
+    RoiRecord toRecord() const;
+    bool fromRecord(const RoiRecord &record);
+    void writeXml(QXmlStreamWriter &writer) const;
+    bool readXml(QXmlStreamReader &reader);
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+private:
+    QPoint m_point;
+    bool m_isMoving;
+
+    void moveShape(const QPointF &pos);
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+signals:
+    void positionChanged();
+    void ROITransformStarted();
+    void ROITransformFinished();
+};
+
+QGraphicsObject* createRoiItem(const RoiRecord &record);
+bool roiItemRecord(QGraphicsObject *item, RoiRecord &record);
+
+
+#endif // SIMPLEROI_H
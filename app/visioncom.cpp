@@ -0,0 +1,276 @@
+#include "visioncom.h"
+#include "pixelconvert.h"
+#include "displaymapper.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief grayColorTable  Indexed8灰度调色板，只构建一次
+ * @return
+ */
+static const QVector<QRgb>& grayColorTable()
+{
+    static const QVector<QRgb> table =[]{
+        QVector<QRgb> colors(256);
+        for(int i =0; i <256; i++)
+            colors[i] =qRgb(i, i, i);
+        return colors;
+    }();
+    return table;
+}
+
+/**
+ * @brief GlobalFuncs::cvMat2QImage
+ * 注意：返回为深拷贝；16位、浮点等图像按最小最大值拉伸到8位(见DisplayMapper)
+ * @param mat
+ * @return
+ */
+QImage cvMat2QImage(const cv::Mat &mat)
+{
+    if(mat.empty())  return QImage();
+    if(mat.type() == CV_8UC1)
+    {
+        QImage image(mat.cols, mat.rows, QImage::Format_Indexed8);
+        image.setColorTable(grayColorTable());
+        convertPixels(mat, image.bits(), image.bytesPerLine(), PIXEL_GRAY8_TO_GRAY8);
+        return image;
+    }
+    else if(mat.type() == CV_8UC3)
+    {
+        QImage image(mat.cols, mat.rows, QImage::Format_RGB888);
+        convertPixels(mat, image.bits(), image.bytesPerLine(), PIXEL_BGR888_TO_RGB888);
+        return image;
+    }
+    else if(mat.type() == CV_8UC4)
+    {
+        const uchar *pSrc = (const uchar*)mat.data;
+        QImage image(pSrc, mat.cols, mat.rows, mat.step, QImage::Format_ARGB32);
+        return image.copy();
+    }
+    else if(mat.depth() !=CV_8U && (mat.channels() ==1 || mat.channels() ==3 || mat.channels() ==4))
+    {
+        DisplayMapper mapper;
+        mapper.setSource(mat);
+        return mapper.image();
+    }
+    else
+    {
+        return QImage();
+    }
+
+}
+
+/**
+ * @brief cvMat2QImageRGB32
+ * 转换为RGB32，QPixmap在光栅后端上可直接使用该格式，上传时无需再转换。返回为深拷贝
+ * @param mat
+ * @return
+ */
+QImage cvMat2QImageRGB32(const cv::Mat &mat)
+{
+    if(mat.empty())  return QImage();
+    if(mat.type() ==CV_8UC1 || mat.type() ==CV_8UC3)
+    {
+        QImage image(mat.cols, mat.rows, QImage::Format_RGB32);
+        PixelKernel kernel =mat.type() ==CV_8UC1 ? PIXEL_GRAY8_TO_RGB32 : PIXEL_BGR888_TO_RGB32;
+        convertPixels(mat, image.bits(), image.bytesPerLine(), kernel);
+        return image;
+    }
+    return cvMat2QImage(mat).convertToFormat(QImage::Format_RGB32);
+}
+
+
+/**
+ * @brief GlobalFuncs::QImage2cvMat
+ * 注意：返回为浅拷贝；RGB888需要交换通道，返回为深拷贝，不会改动image的数据
+ * @param image
+ * @return
+ */
+cv::Mat QImage2cvMat(const QImage &image)
+{
+    cv::Mat mat;
+    switch (image.format())
+    {
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        mat = cv::Mat(image.height(), image.width(), CV_8UC4, (void*)image.constBits(), image.bytesPerLine());
+        break;
+    case QImage::Format_RGB888:
+    {
+        cv::Mat view(image.height(), image.width(), CV_8UC3, (void*)image.constBits(), image.bytesPerLine());
+        mat.create(image.height(), image.width(), CV_8UC3);
+        convertPixels(view, mat.data, mat.step, PIXEL_BGR888_TO_RGB888);
+        break;
+    }
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+        mat = cv::Mat(image.height(), image.width(), CV_8UC1, (void*)image.constBits(), image.bytesPerLine());
+        break;
+    default:
+        break;
+    }
+    return mat;
+}
+
+
+static void releaseSharedMat(void *info)
+{
+    delete static_cast<cv::Mat*>(info);
+}
+
+/**
+ * @brief cvMat2QImageShared
+ * 零拷贝转换：返回的QImage直接引用mat的像素数据，并持有mat的一份引用，
+ * 因此mat被释放或重新分配后QImage依然有效；对QImage写入时会自动分离(深拷贝)，不会改动mat。
+ * 只有格式确实需要转换时(如Qt 5.14以下的CV_8UC3、16位和浮点图像)才退化为cvMat2QImage
+ * @param mat
+ * @return
+ */
+QImage cvMat2QImageShared(const cv::Mat &mat)
+{
+    return cvMat2QImageShared(mat, QVector<QRgb>());
+}
+
+/**
+ * @brief cvMat2QImageShared
+ * 同上，CV_8UC1且colorTable非空时返回带该调色板的Indexed8，用于伪彩色显示
+ * @param mat
+ * @param colorTable
+ * @return
+ */
+QImage cvMat2QImageShared(const cv::Mat &mat, const QVector<QRgb> &colorTable)
+{
+    if(mat.empty())  return QImage();
+    QImage::Format format;
+    switch (mat.type()) {
+    case CV_8UC1:
+        format =colorTable.isEmpty() ? QImage::Format_Grayscale8 : QImage::Format_Indexed8;
+        break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    case CV_8UC3:
+        format =QImage::Format_BGR888;
+        break;
+#endif
+    case CV_8UC4:
+        format =QImage::Format_ARGB32;
+        break;
+    default:
+        return cvMat2QImage(mat);
+    }
+    cv::Mat *holder =new cv::Mat(mat);
+    const uchar *pSrc =holder->data;
+    QImage image(pSrc, holder->cols, holder->rows, static_cast<int>(holder->step), format,
+                 releaseSharedMat, holder);
+    if(format ==QImage::Format_Indexed8)
+        image.setColorTable(colorTable);
+    return image;
+}
+
+/**
+ * @brief sampleRect
+ * 按矩形取像素，rect为像素边界坐标(像素i占[i, i+1))。输出像素(u, v)的中心对应图像中的(x +u +0.5, y +v +0.5)，
+ * 超出图像的部分复制边缘。各边都是整数且在图像内时直接返回image的子视图，不复制、不插值；
+ * 否则先按复制边缘取出覆盖的(宽+1)x(高+1)个源像素，再以双精度做精确的双线性插值
+ * (不使用warpAffine/remap，它们把插值权重量化到1/32像素，且不支持CV_32S)，结果四舍五入回原深度
+ * @param image  任意深度(CV_8U~CV_64F，含CV_32S)和通道数
+ * @param rect
+ * @return  尺寸为rect宽高四舍五入(至少1)，类型与image相同
+ */
+cv::Mat sampleRect(const cv::Mat &image, const QRectF &rect)
+{
+    if(image.empty() || rect.isEmpty())  return cv::Mat();
+    int width =qMax(1, qRound(rect.width())), height =qMax(1, qRound(rect.height()));
+    qreal x =rect.x(), y =rect.y();
+    bool aligned =x ==std::floor(x) && y ==std::floor(y) && rect.width() ==width && rect.height() ==height;
+    if(aligned && x >=0 && y >=0 && x +width <=image.cols && y +height <=image.rows)
+        return image(cv::Rect(int(x), int(y), width, height));
+
+    //输出(u, v)对应的像素坐标为(x +u, y +v)，整数部分逐点递增，小数部分fx、fy对所有输出相同
+    int ix =int(std::floor(x)), iy =int(std::floor(y));
+    double fx =x -ix, fy =y -iy;
+    int spanX =fx >0 ? width +1 : width, spanY =fy >0 ? height +1 : height;
+    std::vector<int> columns(spanX);
+    for(int c =0; c <spanX; ++c)
+        columns[c] =qBound(0, ix +c, image.cols -1);
+    const size_t elem =image.elemSize();
+    cv::Mat region(spanY, spanX, image.type());
+    for(int r =0; r <spanY; ++r){
+        const uchar *src =image.ptr<uchar>(qBound(0, iy +r, image.rows -1));
+        uchar *dst =region.ptr<uchar>(r);
+        for(int c =0; c <spanX; ++c)
+            std::memcpy(dst +c *elem, src +columns[c] *elem, elem);
+    }
+    if(fx ==0 && fy ==0)  return region;
+
+    cv::Mat values;
+    region.convertTo(values, CV_64F);
+    if(fx >0){
+        cv::Mat blend;
+        cv::addWeighted(values.colRange(0, width), 1 -fx, values.colRange(1, width +1), fx, 0, blend);
+        values =blend;
+    }
+    if(fy >0){
+        cv::Mat blend;
+        cv::addWeighted(values.rowRange(0, height), 1 -fy, values.rowRange(1, height +1), fy, 0, blend);
+        values =blend;
+    }
+    cv::Mat patch;
+    values.convertTo(patch, image.depth());
+    return patch;
+}
+
+
+//class QImageMat  QImage -> cv::Mat 零拷贝视图
+
+QImageMat::QImageMat() :m_shared(false)
+{
+
+}
+
+/**
+ * @brief QImageMat::QImageMat
+ * 内存布局与OpenCV一致的格式直接共享QImage数据(isShared()为true)；
+ * RGB888需要交换通道，转换为独立的BGR图像；其余格式先转换为ARGB32，mat()引用转换后的副本
+ * @param image
+ */
+QImageMat::QImageMat(const QImage &image) :m_shared(false)
+{
+    if(image.isNull())  return;
+    switch (image.format())
+    {
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        m_image =image;
+        m_mat =cv::Mat(m_image.height(), m_image.width(), CV_8UC4, (void*)m_image.constBits(), m_image.bytesPerLine());
+        m_shared =true;
+        break;
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+        m_image =image;
+        m_mat =cv::Mat(m_image.height(), m_image.width(), CV_8UC1, (void*)m_image.constBits(), m_image.bytesPerLine());
+        m_shared =true;
+        break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    case QImage::Format_BGR888:
+        m_image =image;
+        m_mat =cv::Mat(m_image.height(), m_image.width(), CV_8UC3, (void*)m_image.constBits(), m_image.bytesPerLine());
+        m_shared =true;
+        break;
+#endif
+    case QImage::Format_RGB888:
+    {
+        cv::Mat view(image.height(), image.width(), CV_8UC3, (void*)image.constBits(), image.bytesPerLine());
+        m_mat.create(image.height(), image.width(), CV_8UC3);
+        convertPixels(view, m_mat.data, m_mat.step, PIXEL_BGR888_TO_RGB888);
+        break;
+    }
+    default:
+        m_image =image.convertToFormat(QImage::Format_ARGB32);
+        m_mat =cv::Mat(m_image.height(), m_image.width(), CV_8UC4, (void*)m_image.constBits(), m_image.bytesPerLine());
+        break;
+    }
+}
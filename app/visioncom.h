@@ -0,0 +1,35 @@
+#ifndef VISIONCOM_H
+#define VISIONCOM_H
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <QImage>
+#include <QRectF>
+
+QImage cvMat2QImage(const cv::Mat &mat);
+cv::Mat QImage2cvMat(const QImage &image);
+QImage cvMat2QImageShared(const cv::Mat &mat);
+QImage cvMat2QImageShared(const cv::Mat &mat, const QVector<QRgb> &colorTable);
+QImage cvMat2QImageRGB32(const cv::Mat &mat);
+cv::Mat sampleRect(const cv::Mat &image, const QRectF &rect);
+
+/**
+ * @brief The QImageMat class
+ * QImage到cv::Mat的零拷贝视图，内部持有QImage的引用计数，
+ * 只要本对象存在，mat()指向的数据就有效；mat()应视为只读
+ */
+class QImageMat
+{
+public:
+    QImageMat();
+    explicit QImageMat(const QImage &image);
+
+    const cv::Mat& mat() const  { return m_mat;}
+    const QImage& image() const  { return m_image;}
+    bool isShared() const  { return m_shared;}
+private:
+    QImage m_image;
+    cv::Mat m_mat;
+    bool m_shared;
+};
+
+#endif // VISIONCOM_H
@@ -0,0 +1,444 @@
+#include "visionwidgets.h"
+#include "visioncom.h"
+#include "roibatchlayer.h"
+#include "roihitindex.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <cmath>
+#include <QLayout>
+#include <QSplitter>
+#include <QLabel>
+
+//class DispImageView  图像显示窗口
+
+#define FRAME_TIME_SMOOTH 0.1 //帧耗时指数平均系数
+#define ZOOM_MIN 0.05 //最小缩放比例
+#define ZOOM_MAX 50   //最大缩放比例
+#define ZOOM_TICK_MS 16  //缩放刷新节拍，约一个显示帧
+#define ZOOM_EASE 0.4    //每个节拍向目标比例逼近的比例，形成平滑动画
+
+DispImageView::DispImageView(QWidget *p) :QGraphicsView(p), m_source(nullptr),
+    m_renderMode(RENDER_ITEM), m_frameTime(0), m_zoomDelta(0.1), m_zoomTarget(1), m_batchLayer(nullptr)
+{
+    m_scene.addItem(&m_image);
+    m_scene.addItem(&m_stream);
+    m_stream.hide();
+    setScene(&m_scene);
+    m_ring.setNotifier([this]{ notifyFrame();});
+    connect(&m_image, &TiledImageItem::contentChanged, this, &DispImageView::onImageContentChanged);
+    setRenderMode(RENDER_CACHED);
+    m_zoomTimer.setInterval(ZOOM_TICK_MS);
+    connect(&m_zoomTimer, &QTimer::timeout, this, &DispImageView::onZoomTick);
+}
+
+DispImageView::~DispImageView()
+{
+    stopStream();
+}
+
+void DispImageView::setBackImage(const QImage &img)
+{
+    m_image.setScale(1);
+    m_image.setImage(img);
+}
+
+/**
+ * @brief DispImageView::setBackSource
+ * 显示原始图像，高位深图像由背景图形项常驻的DisplayMapper按块映射
+ * @param src
+ */
+void DispImageView::setBackSource(const cv::Mat &src)
+{
+    m_image.setScale(1);
+    m_image.setSource(src);
+}
+
+/**
+ * @brief DispImageView::setDisplayRange  窗宽窗位，只重新映射可见的块
+ * @param low
+ * @param high
+ */
+void DispImageView::setDisplayRange(double low, double high)
+{
+    m_image.setDisplayRange(low, high);
+}
+
+/**
+ * @brief DispImageView::batchLayer
+ * 大批量ROI显示层，第一次调用时创建并加入场景，位于背景图像之上；由场景管理生命周期
+ * @return
+ */
+RoiBatchLayer* DispImageView::batchLayer()
+{
+    if(!m_batchLayer){
+        m_batchLayer =new RoiBatchLayer;
+        m_batchLayer->setZValue(m_image.zValue() +1);
+        m_scene.addItem(m_batchLayer);
+    }
+    return m_batchLayer;
+}
+
+/**
+ * @brief DispImageView::setPreviewImage
+ * 显示低分辨率预览图，按scale放大到原图尺寸，保证场景坐标与原图像素一致
+ * @param img
+ * @param scale  原图与预览图的尺寸比
+ */
+void DispImageView::setPreviewImage(const QImage &img, qreal scale)
+{
+    m_image.setScale(scale);
+    m_image.setImage(img);
+}
+
+/**
+ * @brief DispImageView::updateBackImageRegion
+ * 局部更新背景图像，只重绘rect对应的场景区域，用于叠加显示ROI处理结果等
+ * @param rect  图像像素坐标
+ * @param patch  与rect同尺寸
+ */
+void DispImageView::updateBackImageRegion(const QRect &rect, const cv::Mat &patch)
+{
+    m_image.updateRegion(rect, patch);
+}
+
+/**
+ * @brief DispImageView::startStream
+ * 进入实时流模式，source在后台线程推送帧，显示端只取最新帧，来不及绘制的帧被丢弃
+ * @param source  不转移所有权
+ */
+void DispImageView::startStream(FrameSource *source)
+{
+    stopStream();
+    m_ring.resetStats();
+    m_image.hide();
+    m_stream.show();
+    onImageContentChanged(QRectF());
+    m_source =source;
+    if(m_source)  m_source->start(&m_ring);
+}
+
+/**
+ * @brief DispImageView::stopStream  退出实时流模式，恢复背景图像显示
+ */
+void DispImageView::stopStream()
+{
+    if(m_source){
+        m_source->stop();
+        m_source =nullptr;
+    }
+    m_stream.hide();
+    m_image.show();
+    onImageContentChanged(QRectF());
+}
+
+/**
+ * @brief DispImageView::pushFrame
+ * 线程安全(单生产者)：供相机回调直接推送帧，数据拷贝到帧环的写缓冲
+ * @param frame
+ */
+void DispImageView::pushFrame(const cv::Mat &frame)
+{
+    frame.copyTo(m_ring.writeBuffer());
+    m_ring.publish();
+}
+
+/**
+ * @brief DispImageView::notifyFrame
+ * 生产者线程调用：GUI线程中已有未处理的显示请求时不再投递，事件队列不会堆积
+ */
+void DispImageView::notifyFrame()
+{
+    if(!m_frameQueued.testAndSetOrdered(0, 1))  return;
+    QMetaObject::invokeMethod(this, [this]{ presentFrame();}, Qt::QueuedConnection);
+}
+
+/**
+ * @brief DispImageView::presentFrame  GUI线程：取最新帧更新显示
+ */
+void DispImageView::presentFrame()
+{
+    m_frameQueued.storeRelease(0);
+    if(!m_stream.isVisible() || !m_ring.acquire())  return;
+    m_stream.setFrame(m_ring.readBuffer());
+    m_ring.markDisplayed();
+}
+
+/**
+ * @brief DispImageView::setRenderMode
+ * RENDER_CACHED：背景图像在drawBackground中绘制并由CacheBackground缓存为视口分辨率的像素图，
+ * 只有ROI等图形项变化时直接复用缓存，平移时Qt滚动缓存只补画新露出的部分；
+ * SmartViewportUpdate按变化区域的多少选择最小区域或外接矩形重绘
+ * @param mode
+ */
+void DispImageView::setRenderMode(RenderMode mode)
+{
+    m_renderMode =mode;
+    bool cached =mode ==RENDER_CACHED;
+    m_image.setPaintedByView(cached);
+    setCacheMode(cached ? QGraphicsView::CacheBackground : QGraphicsView::CacheNone);
+    setViewportUpdateMode(cached ? QGraphicsView::SmartViewportUpdate : QGraphicsView::MinimalViewportUpdate);
+    resetCachedContent();
+    viewport()->update();
+}
+
+/**
+ * @brief DispImageView::drawBackground  缓存模式下在背景层绘制图像
+ * @param painter
+ * @param rect  场景坐标
+ */
+void DispImageView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+    if(m_renderMode !=RENDER_CACHED || !m_image.isVisible())  return;
+    painter->save();
+    painter->setTransform(m_image.sceneTransform(), true);
+    m_image.paintRegion(painter, m_image.mapRectFromScene(rect));
+    painter->restore();
+}
+
+/**
+ * @brief DispImageView::paintEvent  统计每帧绘制耗时(毫秒，指数平均)
+ * @param event
+ */
+void DispImageView::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QGraphicsView::paintEvent(event);
+    qreal ms =timer.nsecsElapsed() /1e6;
+    m_frameTime =m_frameTime ==0 ? ms : m_frameTime +FRAME_TIME_SMOOTH *(ms -m_frameTime);
+}
+
+/**
+ * @brief DispImageView::onImageContentChanged  背景图像变化时只作废背景缓存的对应区域
+ * @param rect  图像坐标，为空表示整幅图像
+ */
+void DispImageView::onImageContentChanged(const QRectF &rect)
+{
+    if(m_renderMode !=RENDER_CACHED)  return;
+    if(rect.isEmpty()){
+        resetCachedContent();
+        viewport()->update();
+    }
+    else{
+        invalidateScene(m_image.mapRectToScene(rect), QGraphicsScene::BackgroundLayer);
+    }
+}
+
+/**
+ * @brief DispImageView::wheelEvent
+ * 只累积目标缩放比例，不立即变换；高精度触控板的大量滚轮事件在一个节拍内合并为一次变换
+ * @param event
+ */
+void DispImageView::wheelEvent(QWheelEvent *event)
+{
+    if(!m_zoomTimer.isActive())
+        m_zoomTarget =transform().m11();
+    qreal steps =event->angleDelta().y() /120.0;
+    m_zoomTarget =qBound<qreal>(ZOOM_MIN, m_zoomTarget *std::pow(1 +m_zoomDelta, steps), ZOOM_MAX);
+    m_zoomAnchor =event->pos();
+    if(!m_zoomTimer.isActive())
+        m_zoomTimer.start();
+    event->accept();
+}
+
+/**
+ * @brief DispImageView::mousePressEvent
+ * 按下位置先经场景的RoiHitIndex查询一次(控制点 >边 >内部，同级取Z值高者)，
+ * 光标下的ROI图形按查询结果决定接收还是忽略，不再各自判断区域
+ * @param event
+ */
+void DispImageView::mousePressEvent(QMouseEvent *event)
+{
+    RoiHitIndex *index =RoiHitIndex::forScene(&m_scene);
+    index->beginPress(mapToScene(event->pos()));
+    QGraphicsView::mousePressEvent(event);
+    index->endPress();
+}
+
+/**
+ * @brief DispImageView::mouseMoveEvent  发出鼠标所在的场景坐标，用于像素值探测
+ * @param event
+ */
+void DispImageView::mouseMoveEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseMoveEvent(event);
+    emit mouseMovedOnScene(mapToScene(event->pos()));
+}
+
+/**
+ * @brief DispImageView::onZoomTick  每个节拍向目标比例逼近一步，到达后停止
+ */
+void DispImageView::onZoomTick()
+{
+    qreal current =transform().m11();
+    qreal next =current +(m_zoomTarget -current) *ZOOM_EASE;
+    if(std::abs(next /m_zoomTarget -1) <0.002){
+        next =m_zoomTarget;
+        m_zoomTimer.stop();
+    }
+    zoom(next, m_zoomAnchor);
+}
+
+/**
+ * @brief DispImageView::zoom
+ * 以anchor处的场景点为不动点缩放到scale。放大超过1:1时使用最近邻采样，
+ * 缩小时平滑采样并由金字塔提供分辨率不超过屏幕两倍的层，每帧采样的像素数与视口大小相当，与缩放比例无关
+ * @param scale  场景到视口的缩放比例
+ * @param anchor  视口坐标
+ */
+void DispImageView::zoom(qreal scale, const QPoint &anchor)
+{
+    QPointF scenePos =mapToScene(anchor);
+    setTransform(QTransform::fromScale(scale, scale));
+    QPointF moved =mapFromScene(scenePos) -QPointF(anchor);
+    horizontalScrollBar()->setValue(horizontalScrollBar()->value() +qRound(moved.x()));
+    verticalScrollBar()->setValue(verticalScrollBar()->value() +qRound(moved.y()));
+    setRenderHint(QPainter::SmoothPixmapTransform, scale <1);
+    if(m_renderMode ==RENDER_CACHED)  resetCachedContent();
+}
+
+
+//class DockWindow  自定义悬靠窗口
+
+DockWindow::DockWindow(QWidget *p, bool b) :QDockWidget(p)
+{
+    m_toolBar =new MyToolBar(this);
+    QWidget *pTitle =titleBarWidget();
+    setTitleBarWidget(m_toolBar);
+    if(pTitle)  delete pTitle;
+
+    if(b){
+        QWidget *spacer =new QWidget(this);
+        spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+        m_toolBar->addWidget(spacer);
+        QAction *hideAction =m_toolBar->addAction(QIcon(), QString());
+        hideAction->setIcon(QIcon(":/icons/icon-delete"));
+        connect(hideAction, &QAction::triggered, this, &QWidget::hide);
+    }
+
+    setFeatures(0);
+    setMinimumHeight(100);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+DockWindow::~DockWindow()
+{
+
+}
+
+void DockWindow::setTitle(const QString &title)
+{
+    m_toolBar->setTitleLabel(title);
+}
+
+MyToolBar* DockWindow::dockWindowToolBar() const
+{
+    return m_toolBar;
+}
+
+
+//class MyToolBar  自定义工具栏
+
+MyToolBar::MyToolBar(QWidget *p) :QToolBar(p)
+{
+    initialize();
+}
+
+MyToolBar::MyToolBar(const QString &title, QWidget *p) :QToolBar(title, p)
+{
+    initialize();
+}
+
+MyToolBar::~MyToolBar()
+{
+
+}
+
+void MyToolBar::setTitleLabel(const QString &title)
+{
+    if(m_title){
+        m_title->setText(title +" ");
+    }
+    else{
+        QAction *separator0;
+        if(actions().isEmpty())
+            separator0 =addSeparator();
+        else
+            separator0 =insertSeparator(actions().at(0));
+        m_title =new QLabel(title +" ", this);
+        insertWidget(separator0, m_title);
+    }
+}
+
+void MyToolBar::addActionToLeft(QAction *action)
+{
+    if(actions().isEmpty()){
+        addAction(action);
+        return;
+    }
+    QAction *after;
+    if(m_title){
+        if(actions().size() <=2)
+            addAction(action);
+        else{
+            after =actions().at(2);
+            insertAction(after, action);
+        }
+    }
+    else{
+        after =actions().at(0);
+        insertAction(after, action);
+    }
+}
+
+QAction* MyToolBar::addWidgetToLeft(QWidget *widget)
+{
+    if(actions().isEmpty())
+        return addWidget(widget);
+    QAction *after;
+    if(m_title){
+        if(actions().size() <=2)
+            return addWidget(widget);
+        else{
+            after =actions().at(2);
+            return insertWidget(after, widget);
+        }
+    }
+    else{
+        after =actions().at(0);
+        return insertWidget(after, widget);
+    }
+}
+
+QAction* MyToolBar::addSeparatorToLeft()
+{
+    if(actions().isEmpty())
+        return addSeparator();
+    QAction *after;
+    if(m_title){
+        if(actions().size() <=2)
+            return addSeparator();
+        else{
+            after =actions().at(2);
+            return insertSeparator(after);
+        }
+    }
+    else{
+        after =actions().at(0);
+        return insertSeparator(after);
+    }
+}
+
+QSize MyToolBar::sizeHint() const
+{
+    return QSize(84, 25);
+}
+
+void MyToolBar::initialize()
+{
+    setStyleSheet("background-color:lightblue");
+}
+
@@ -0,0 +1,112 @@
+#ifndef VISIONWIDGETS_H
+#define VISIONWIDGETS_H
+
+#include <QGraphicsView>
+#include <QGraphicsItem>
+#include <QWheelEvent>
+#include <QDockWidget>
+#include <QToolBar>
+#include <QTimer>
+#include "imageitems.h"
+#include "framestream.h"
+
+class RoiBatchLayer;
+
+class DispImageView :public QGraphicsView
+{
+    Q_OBJECT
+public:
+    enum RenderMode {RENDER_ITEM,       //背景图像作为普通图形项绘制
+                     RENDER_CACHED};    //背景图像绘制到视口分辨率的背景缓存，ROI变化和平移只重绘变化部分
+
+    DispImageView(QWidget *parent =nullptr);
+    ~DispImageView();
+
+    QGraphicsScene* myScene()  { return &m_scene;}
+    void setBackImage(const QImage &img);
+    void setBackSource(const cv::Mat &src);
+    void setDisplayRange(double low, double high);
+    const DisplayMapper& displayMapper() const  { return m_image.displayMapper();}
+    RoiBatchLayer* batchLayer();
+    void setPreviewImage(const QImage &img, qreal scale);
+    void updateBackImageRegion(const QRect &rect, const cv::Mat &patch);
+
+    void startStream(FrameSource *source);
+    void stopStream();
+    bool isStreaming() const  { return m_source !=nullptr;}
+    void pushFrame(const cv::Mat &frame);
+    StreamStats streamStats() const  { return m_ring.stats();}
+
+    void setRenderMode(RenderMode mode);
+    RenderMode renderMode() const  { return m_renderMode;}
+    qreal frameTime() const  { return m_frameTime;}
+protected:
+    void wheelEvent(QWheelEvent *event);
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QGraphicsScene m_scene;
+    TiledImageItem m_image;
+    StreamImageItem m_stream;
+    FrameRing m_ring;
+    FrameSource *m_source;
+    QAtomicInt m_frameQueued;
+    RenderMode m_renderMode;
+    qreal m_frameTime;
+    qreal m_zoomDelta;
+    qreal m_zoomTarget;
+    QPoint m_zoomAnchor;
+    QTimer m_zoomTimer;
+    RoiBatchLayer *m_batchLayer;
+
+    void zoom(qreal scale, const QPoint &anchor);
+    void onZoomTick();
+    void notifyFrame();
+    void presentFrame();
+    void onImageContentChanged(const QRectF &rect);
+signals:
+    void mouseMovedOnScene(const QPointF &scenePos);
+};
+
+class QLabel;
+class MyToolBar;
+
+class DockWindow :public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    DockWindow(QWidget *parent =nullptr, bool isClosable =true);
+    ~DockWindow();
+
+    void setTitle(const QString &text);
+    MyToolBar* dockWindowToolBar() const;
+
+private:
+    MyToolBar *m_toolBar;
+};
+
+class MyToolBar :public QToolBar
+{
+    friend class DockWindow;
+
+public:
+    MyToolBar(QWidget *parent =nullptr);
+    MyToolBar(const QString &title, QWidget *parent =nullptr);
+    ~MyToolBar();
+
+    void setTitleLabel(const QString &title);
+    void addActionToLeft(QAction *action);
+    QAction* addWidgetToLeft(QWidget *widget);
+    QAction *addSeparatorToLeft();
+
+    QSize sizeHint() const override;
+private:
+    QLabel *m_title =nullptr;
+    void initialize();
+};
+
+#endif // VISIONWIDGETS_H
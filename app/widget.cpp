@@ -0,0 +1,371 @@
+#include "widget.h"
+#include "ui_widget.h"
+
+#include <iostream>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <QFileDialog>
+#include <QTransform>
+#include <QtMath>
+#include <QGraphicsSimpleTextItem>
+#include <QRegion>
+#include <QAction>
+#include <QMessageBox>
+#include "visioncom.h"
+#include "visionwidgets.h"
+#include "simpleroi.h"
+#include "imageloader.h"
+#include "roihistogram.h"
+#include "roipipeline.h"
+#include "liveworker.h"
+#include "roiundo.h"
+
+using namespace cv;
+using std::vector;
+
+template <typename T>
+void printMat(Mat &src)
+{
+    for(int i =0; i <src.rows; ++i){
+        for(int j =0; j <src.cols -1; ++j){
+            std::cout<<src.at<T>(i, j)<<", ";
+        }
+        if(src.cols >0)  std::cout<<src.at<T>(i, src.cols -1);
+        std::cout<<std::endl;
+    }
+}
+
+Widget::Widget(QWidget *parent)
+    : QWidget(parent)
+    , ui(new Ui::Widget)
+{
+    ui->setupUi(this);
+    m_imageView =new DispImageView(this);
+    ui->showLayout->addWidget(m_imageView);
+
+    m_ROI =new SimpleROI;
+    m_ROI->setZValue(996);
+    m_caliper =new CaliperTool;   
+    m_caliper->setZValue(998);
+    m_point =new SimpleMovablePoint;
+    m_point->setZValue(999);
+    m_imageView->myScene()->addItem(m_ROI);
+    m_imageView->myScene()->addItem(m_caliper);
+    m_imageView->myScene()->addItem(m_point);
+    m_caliper->hide();
+    m_point->hide();
+    RoiHitIndex *hitIndex =RoiHitIndex::forScene(m_imageView->myScene());
+    hitIndex->addItem(m_ROI);
+    hitIndex->addItem(m_caliper);
+    hitIndex->addItem(m_point);
+
+    m_resItem =new QGraphicsSimpleTextItem("");
+    m_resItem->setBrush(Qt::green);
+    m_resItem->setFont(QFont("Microsoft YaHei"));
+    m_resItem->setPos(100, 100);
+    m_imageView->myScene()->addItem(m_resItem);
+
+    m_probeItem =new QGraphicsSimpleTextItem("");
+    m_probeItem->setBrush(Qt::yellow);
+    m_probeItem->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    m_probeItem->setZValue(1000);
+    m_imageView->myScene()->addItem(m_probeItem);
+    m_histogram =new RoiHistogram;
+    m_histItem =new HistogramItem;
+    m_histItem->setZValue(1000);
+    m_imageView->myScene()->addItem(m_histItem);
+    m_inputMin =m_stageMin =0;
+    m_inputMax =m_stageMax =255;
+    m_pipeline =new RoiPipeline;
+    setupPipeline();
+    m_liveCaliper =new CaliperEngine;
+    m_roiWorker =new LiveWorker(this);
+    m_caliperWorker =new LiveWorker(this);
+    connect(m_imageView, &DispImageView::mouseMovedOnScene, this, &Widget::probePixel);
+    connect(m_ROI, &SimpleROI::ROIChanged, this, &Widget::updateROIHistogram);
+    connect(m_caliper, &CaliperTool::ROIChanged, this, &Widget::measureCaliper);
+    connect(m_caliper, &CaliperTool::ROITransformFinished, this, &Widget::measureCaliper);
+    connect(m_ROI, &SimpleROI::ROIChanged, this, &Widget::processROI);
+    connect(m_ROI, &SimpleROI::ROITransformFinished, this, &Widget::processROI);
+
+    setupUndo();
+
+    m_previewShown =false;
+    m_loader =new ImageLoader(this);
+    connect(m_loader, &ImageLoader::previewReady, this, &Widget::onPreviewLoaded);
+    connect(m_loader, &ImageLoader::imageReady, this, &Widget::onImageLoaded);
+    connect(m_loader, &ImageLoader::loadFailed, this, &Widget::onLoadFailed);
+
+    connect(ui->ROIBox, SIGNAL(activated(int)), this, SLOT(changeROI(int)));
+}
+
+Widget::~Widget()
+{
+    m_roiWorker->stop();
+    m_caliperWorker->stop();
+    delete m_histogram;
+    delete m_pipeline;
+    delete m_liveCaliper;
+    delete ui;
+}
+
+/**
+ * @brief Widget::setupUndo  登记ROI和大批量ROI层的撤销/重做，快捷键Ctrl+Z、Ctrl+Y
+ */
+void Widget::setupUndo()
+{
+    m_undo =new RoiUndoRecorder(this);
+    m_undo->addItem(m_ROI);
+    m_undo->addItem(m_caliper);
+    m_undo->addItem(m_point);
+    m_undo->addLayer(m_imageView->batchLayer());
+    QAction *undoAction =m_undo->undoStack()->createUndoAction(this);
+    undoAction->setShortcut(QKeySequence::Undo);
+    QAction *redoAction =m_undo->undoStack()->createRedoAction(this);
+    redoAction->setShortcut(QKeySequence(Qt::CTRL +Qt::Key_Y));
+    addAction(undoAction);
+    addAction(redoAction);
+}
+
+void Widget::showImageOnLabel(Mat &mat)
+{
+    QImage image =cvMat2QImageShared(mat);
+    m_imageView->setBackImage(image);
+}
+
+void Widget::on_getpicBt_clicked()
+{
+    QString path =QFileDialog::getOpenFileName(this, "get image", "D:/QtDemos/Pictures/QiHe", "Image(*jpg *jpeg *png *bmp *tif *tiff)");
+    if(path.isEmpty())  return;
+    m_loader->load(path);
+}
+
+/**
+ * @brief Widget::onImageLoaded  后台加载完成，image已完成显示转换
+ * @param gray
+ * @param image
+ */
+void Widget::onImageLoaded(const Mat &gray, const QImage &image)
+{
+    m_input =gray;
+    m_backImage =image;
+    m_previewShown =false;
+    m_inputMin =0;
+    m_inputMax =255;
+    if(m_input.depth() !=CV_8U)
+        minMaxLoc(m_input, &m_inputMin, &m_inputMax);
+    showInput();
+    m_histogram->setImage(m_input);
+    updateROIHistogram();
+    m_outputRect =QRect();
+    processROI();
+}
+
+/**
+ * @brief Widget::showInput  以m_input作为背景，8位图像用已转换的m_backImage，高位深图像由视图按块映射
+ */
+void Widget::showInput()
+{
+    if(m_backImage.isNull() && !m_input.empty())
+        m_imageView->setBackSource(m_input);
+    else
+        m_imageView->setBackImage(m_backImage);
+}
+
+/**
+ * @brief Widget::onPreviewLoaded  完整图像就绪前先显示预览，预览期间暂停ROI处理结果的叠加，完整图像就绪后重新叠加
+ * @param image
+ * @param scale
+ */
+void Widget::onPreviewLoaded(const QImage &image, qreal scale)
+{
+    m_previewShown =true;
+    m_roiWorker->cancel();
+    m_outputRect =QRect();
+    m_imageView->setPreviewImage(image, scale);
+}
+
+/**
+ * @brief Widget::onLoadFailed
+ * 解码失败：背景已换成预览时恢复为当前图像并重新叠加ROI处理结果，然后提示错误。
+ * m_input等保持不变，界面仍对应加载前的图像
+ * @param path
+ */
+void Widget::onLoadFailed(const QString &path)
+{
+    if(m_previewShown){
+        m_previewShown =false;
+        showInput();
+        m_outputRect =QRect();
+        processROI();
+    }
+    QMessageBox::warning(this, "get image", QString("Failed to load image:\n%1").arg(path));
+}
+
+/**
+ * @brief Widget::probePixel  显示鼠标下的原始像素值
+ * @param scenePos
+ */
+void Widget::probePixel(const QPointF &scenePos)
+{
+    int x =qFloor(scenePos.x()), y =qFloor(scenePos.y());
+    if(m_input.empty() || x <0 || y <0 || x >=m_input.cols || y >=m_input.rows){
+        m_probeItem->setText("");
+        return;
+    }
+    QString value;
+    switch (m_input.depth()) {
+    case CV_8U:
+        value =QString::number(m_input.at<uchar>(y, x));
+        break;
+    case CV_16U:
+        value =QString::number(m_input.at<ushort>(y, x));
+        break;
+    case CV_32F:
+        value =QString::number(m_input.at<float>(y, x));
+        break;
+    default:
+        break;
+    }
+    m_probeItem->setText(QString("(%1, %2) %3").arg(x).arg(y).arg(value));
+    m_probeItem->setPos(scenePos +QPointF(12 /m_imageView->transform().m11(), 12 /m_imageView->transform().m11()));
+}
+
+/**
+ * @brief Widget::updateROIHistogram  ROI变化时增量更新直方图
+ */
+void Widget::updateROIHistogram()
+{
+    QRect rect =m_ROI->mapRectToScene(m_ROI->getRect()).toRect();
+    m_histogram->setRect(rect);
+    m_histItem->setHistogram(m_histogram->bins());
+    m_histItem->setPos(rect.bottomLeft() +QPoint(0, 4));
+    m_histItem->setVisible(!m_input.empty() && m_ROI->isVisible());
+}
+
+/**
+ * @brief Widget::measureCaliper
+ * 卡尺拖动中和变换完成后测量并显示结果，测量在工作线程执行，只显示最新几何的结果
+ */
+void Widget::measureCaliper()
+{
+    if(m_input.empty() || !m_caliper->isVisible()){
+        m_caliperWorker->cancel();
+        m_resItem->setText("");
+        return;
+    }
+    Mat input =m_input;
+    CaliperGeometry geometry =m_caliper->geometry();
+    CaliperEngine *engine =m_liveCaliper;
+    QGraphicsSimpleTextItem *resItem =m_resItem;
+    m_caliperWorker->post([=](const LiveJobToken &token) -> std::function<void()>{
+        CaliperResult result;
+        engine->setGeometry(geometry);
+        bool ok =engine->measure(input, result);
+        if(token.isCancelled())  return nullptr;
+        QString text;
+        if(ok && result.pairs.empty())
+            text =QString("edges: %1, no pair").arg(result.edges.size());
+        else if(ok){
+            const CaliperEdgePair &pair =result.pairs.front();
+            text =QString("width: %1  score: %2").arg(pair.width, 0, 'f', 2).arg(pair.score, 0, 'f', 2);
+        }
+        return [resItem, text](){ resItem->setText(text); };
+    });
+}
+
+/**
+ * @brief Widget::setupPipeline
+ * ROI处理步骤：高斯平滑 -> 二值化 -> 开运算。二值化阈值取图像取值范围的中点，结果为最小值/最大值，
+ * 8位图像即固定阈值128、最大值255；输出保持输入的位深，与背景一起按同一映射显示
+ */
+void Widget::setupPipeline()
+{
+    m_pipeline->addStage("blur", [](const Mat &src, Mat &dst){
+        GaussianBlur(src, dst, Size(5, 5), 0);
+    }, 2);
+    m_pipeline->addStage("threshold", [this](const Mat &src, Mat &dst){
+        if(src.depth() ==CV_8U){
+            threshold(src, dst, 128, 255, THRESH_BINARY);
+            return;
+        }
+        Mat mask;
+        compare(src, (m_stageMin +m_stageMax) /2, mask, CMP_GT);
+        mask.convertTo(dst, src.type(), (m_stageMax -m_stageMin) /255, m_stageMin);
+    });
+    m_pipeline->addStage("morphology", [](const Mat &src, Mat &dst){
+        static const Mat kernel =getStructuringElement(MORPH_RECT, Size(3, 3));
+        morphologyEx(src, dst, MORPH_OPEN, kernel);
+    }, 1);
+}
+
+/**
+ * @brief Widget::restoreOutputRegion  上一次叠加的结果中不在keep内的部分恢复为原图
+ * @param keep
+ */
+void Widget::restoreOutputRegion(const QRect &keep)
+{
+    if(m_outputRect.isEmpty() || m_previewShown)  return;
+    for(const QRect &r : QRegion(m_outputRect).subtracted(QRegion(keep)))
+        m_imageView->updateBackImageRegion(r, m_input(Rect(r.x(), r.y(), r.width(), r.height())));
+    m_outputRect =QRect();
+}
+
+/**
+ * @brief Widget::processROI
+ * ROI拖动中和变换完成后在m_input的ROI区域上执行处理流水线。流水线只在工作线程使用，
+ * 新的几何会取消尚未完成的计算，结果回到GUI线程后存入m_output并局部叠加到背景图像。
+ * 背景是缩小的预览图时不处理，由onImageLoaded在完整图像就绪后重新执行
+ */
+void Widget::processROI()
+{
+    if(m_previewShown){
+        m_roiWorker->cancel();
+        return;
+    }
+    if(m_input.empty() || !m_ROI->isVisible()){
+        m_roiWorker->cancel();
+        applyROIOutput(QRect(), Mat());
+        return;
+    }
+    QRect rect =m_ROI->mapRectToScene(m_ROI->getRect()).toRect();
+    Mat input =m_input;
+    RoiPipeline *pipeline =m_pipeline;
+    double inputMin =m_inputMin, inputMax =m_inputMax;
+    m_roiWorker->post([=](const LiveJobToken &token) -> std::function<void()>{
+        Mat output;
+        m_stageMin =inputMin;   //取值范围随图像变化，setImage会同时作废缓存的块
+        m_stageMax =inputMax;
+        pipeline->setImage(input);
+        bool ok =pipeline->run(rect, output, [&token](){ return token.isCancelled();});
+        if(token.isCancelled())  return nullptr;
+        QRect area =ok ? rect.intersected(QRect(0, 0, input.cols, input.rows)) : QRect();
+        return [this, area, output](){ applyROIOutput(area, output);};
+    });
+}
+
+/**
+ * @brief Widget::applyROIOutput  叠加流水线结果，area为空时只恢复原图；预览期间丢弃
+ * @param area
+ * @param output
+ */
+void Widget::applyROIOutput(const QRect &area, const Mat &output)
+{
+    if(m_previewShown)  return;
+    restoreOutputRegion(area);
+    m_output =output;
+    if(area.isEmpty() || output.empty())  return;
+    m_imageView->updateBackImageRegion(area, m_output);
+    m_outputRect =area;
+}
+
+void Widget::changeROI(int index)
+{
+    QList<QGraphicsObject*> temp;
+    temp <<m_ROI <<m_caliper <<m_point;
+    temp[index]->show();
+    temp[(index +1) %3]->hide();
+    temp[(index +2) %3]->hide();
+    updateROIHistogram();
+    processROI();
+}
@@ -0,0 +1,79 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include <QWidget>
+#include <QRect>
+#include <QImage>
+#include <opencv2/core/core.hpp>
+
+using cv::Mat;
+class DispImageView;
+class SimpleROI;
+class CaliperTool;
+class SimpleMovablePoint;
+class QGraphicsSimpleTextItem;
+class ImageLoader;
+class RoiHistogram;
+class HistogramItem;
+class RoiPipeline;
+class CaliperEngine;
+class LiveWorker;
+class RoiUndoRecorder;
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class Widget; }
+QT_END_NAMESPACE
+
+class Widget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    Widget(QWidget *parent = nullptr);
+    ~Widget();
+
+private:
+    Ui::Widget *ui;
+    DispImageView *m_imageView;
+    SimpleROI *m_ROI;
+    CaliperTool *m_caliper;
+    SimpleMovablePoint *m_point;
+    QGraphicsSimpleTextItem *m_resItem;
+    ImageLoader *m_loader;
+    QGraphicsSimpleTextItem *m_probeItem;
+    RoiHistogram *m_histogram;
+    HistogramItem *m_histItem;
+    RoiPipeline *m_pipeline;
+    CaliperEngine *m_liveCaliper;
+    LiveWorker *m_roiWorker;
+    LiveWorker *m_caliperWorker;
+    RoiUndoRecorder *m_undo;
+    Mat m_input;
+    Mat m_output;
+    QRect m_outputRect;
+    QImage m_backImage;     //当前8位图像的显示转换结果，高位深图像为空
+    bool m_previewShown;    //背景已被新请求的预览图替换
+    double m_inputMin;      //m_input的取值范围，8位图像为0~255
+    double m_inputMax;
+    double m_stageMin;      //阈值步骤使用的取值范围，只在ROI工作线程中读写
+    double m_stageMax;
+
+    void showImageOnLabel(Mat &mat);
+    void setupPipeline();
+    void setupUndo();
+    void showInput();
+    void restoreOutputRegion(const QRect &keep);
+    void applyROIOutput(const QRect &area, const Mat &output);
+
+private slots:
+    void on_getpicBt_clicked();
+    void changeROI(int);
+    void onImageLoaded(const cv::Mat &gray, const QImage &image);
+    void onPreviewLoaded(const QImage &image, qreal scale);
+    void onLoadFailed(const QString &path);
+    void probePixel(const QPointF &scenePos);
+    void updateROIHistogram();
+    void measureCaliper();
+    void processROI();
+};
+#endif // WIDGET_H
@@ -0,0 +1,376 @@
+#include "batchrunner.h"
+#include "roigeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const char *g_imageFilters[] ={"*.jpg", "*.jpeg", "*.png", "*.bmp", "*.tif", "*.tiff"};
+
+/**
+ * @brief percentile  最近秩百分位，values会被排序
+ */
+static double percentile(std::vector<qint64> &values, double p)
+{
+    if(values.empty())  return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank =size_t(std::ceil(p /100 *values.size()));
+    return double(values[rank >0 ? rank -1 : 0]);
+}
+
+static QString typeName(quint32 type)
+{
+    switch (type) {
+    case RoiRecord::ROI_RECT:
+        return "rect";
+    case RoiRecord::ROI_CALIPER:
+        return "caliper";
+    case RoiRecord::ROI_POINT:
+        return "point";
+    default:
+        return "unknown";
+    }
+}
+
+
+/**
+ * @brief The BatchRunner::Worker class
+ * 处理线程的私有状态：每个卡尺一个测量引擎，结果容器复用
+ */
+class BatchRunner::Worker
+{
+public:
+    Worker(const std::vector<RoiRecord> &records, const std::vector<CaliperGeometry> &calipers,
+           const CaliperParams &params) :m_records(records), m_engines(records.size())
+    {
+        for(size_t i =0; i <records.size(); i++){
+            if(records[i].type !=RoiRecord::ROI_CALIPER)  continue;
+            m_engines[i].setGeometry(calipers[i]);
+            m_engines[i].setParams(params);
+        }
+    }
+
+    void process(const cv::Mat &image, BatchImageResult &result)
+    {
+        QElapsedTimer timer;
+        result.rois.resize(m_records.size());
+        timer.start();
+        for(size_t i =0; i <m_records.size(); i++){
+            if(m_records[i].type !=RoiRecord::ROI_CALIPER)
+                measureRegion(image, m_records[i], result.rois[i]);
+        }
+        result.roiNs =timer.nsecsElapsed();
+        timer.restart();
+        for(size_t i =0; i <m_records.size(); i++){
+            if(m_records[i].type ==RoiRecord::ROI_CALIPER)
+                measureCaliper(image, m_engines[i], result.rois[i]);
+        }
+        result.caliperNs =timer.nsecsElapsed();
+    }
+private:
+    const std::vector<RoiRecord> &m_records;
+    std::vector<CaliperEngine> m_engines;
+    CaliperResult m_caliper;
+
+    static void measureRegion(const cv::Mat &image, const RoiRecord &record, BatchRoiResult &out)
+    {
+        if(record.type ==RoiRecord::ROI_POINT){
+            int x =int(std::floor(record.x)), y =int(std::floor(record.y));
+            out.valid =x >=0 && y >=0 && x <image.cols && y <image.rows;
+            if(out.valid){
+                cv::Scalar value =cv::mean(image(cv::Rect(x, y, 1, 1)));
+                out.mean =out.minValue =out.maxValue =value[0];
+            }
+            return;
+        }
+        cv::Rect rect(cvRound(record.x), cvRound(record.y), cvRound(record.width), cvRound(record.height));
+        rect &=cv::Rect(0, 0, image.cols, image.rows);
+        out.valid =rect.area() >0;
+        if(!out.valid)  return;
+        cv::Mat view =image(rect);
+        cv::Scalar mean, stddev;
+        cv::meanStdDev(view, mean, stddev);
+        cv::minMaxLoc(view, &out.minValue, &out.maxValue);
+        out.mean =mean[0];
+        out.stddev =stddev[0];
+    }
+
+    void measureCaliper(const cv::Mat &image, CaliperEngine &engine, BatchRoiResult &out)
+    {
+        out.valid =engine.measure(image, m_caliper) && !m_caliper.pairs.empty();
+        out.edgeCount =int(m_caliper.edges.size());
+        if(!out.valid)  return;
+        const CaliperEdgePair &best =m_caliper.pairs.front();
+        out.width =best.width;
+        out.score =best.score;
+        out.first =best.first.point;
+        out.second =best.second.point;
+    }
+};
+
+
+//class BatchRunner  无界面批处理
+
+BatchRunner::BatchRunner(const BatchOptions &options) :m_options(options), m_elapsedNs(0), m_workerCount(0)
+{
+
+}
+
+/**
+ * @brief BatchRunner::run  加载配方，处理目录下全部图像并写出结果
+ * @param error
+ * @return  配方无法读取、没有图像或结果无法写出时返回false
+ */
+bool BatchRunner::run(QString *error)
+{
+    if(!loadRecipe(error))  return false;
+    collectFiles();
+    if(m_files.isEmpty()){
+        if(error)  *error =QString("no images found in %1").arg(m_options.inputDir);
+        return false;
+    }
+    m_results.assign(size_t(m_files.size()), BatchImageResult());
+    m_workerCount =m_options.workers >0 ? m_options.workers : qMax(1, QThread::idealThreadCount());
+    int decoders =qMax(1, m_options.decoders);
+
+    QElapsedTimer timer;
+    timer.start();
+    QThreadPool pool;
+    pool.setMaxThreadCount(decoders +m_workerCount);
+    BatchQueue<Decoded> queue(m_options.prefetch);
+    QAtomicInt next(0), liveDecoders(decoders);
+    for(int i =0; i <decoders; i++){
+        QtConcurrent::run(&pool, [this, &next, &liveDecoders, &queue]{
+            decode(next, queue);
+            if(!liveDecoders.deref())  queue.close();
+        });
+    }
+    for(int i =0; i <m_workerCount; i++){
+        QtConcurrent::run(&pool, [this, &queue]{
+            Worker worker(m_records, m_calipers, m_options.caliper);
+            Decoded item;
+            while(queue.pop(item)){
+                worker.process(item.image, m_results[size_t(item.index)]);
+                item.image.release();
+            }
+        });
+    }
+    pool.waitForDone();
+    m_elapsedNs =timer.nsecsElapsed();
+
+    if(m_options.outputPath.isEmpty())  return true;
+    QSaveFile file(m_options.outputPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)){
+        if(error)  *error =file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out.setRealNumberPrecision(10);
+    if(m_options.json)  writeJson(out);
+    else  writeCsv(out);
+    out.flush();
+    if(!file.commit()){
+        if(error)  *error =file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief BatchRunner::report  输出吞吐量、各阶段耗时百分位(毫秒)和峰值内存
+ * @param out
+ */
+void BatchRunner::report(QTextStream &out) const
+{
+    std::vector<qint64> stages[3];
+    int failed =0;
+    for(const BatchImageResult &result : m_results){
+        if(!result.loaded){
+            failed++;
+            continue;
+        }
+        stages[0].push_back(result.decodeNs);
+        stages[1].push_back(result.roiNs);
+        stages[2].push_back(result.caliperNs);
+    }
+    double seconds =m_elapsedNs /1e9;
+    out <<"images: " <<m_files.size() <<" (failed " <<failed <<"), rois: " <<m_records.size()
+        <<", workers: " <<m_workerCount <<"\n";
+    out <<"elapsed: " <<QString::number(seconds, 'f', 3) <<" s, "
+        <<QString::number(seconds >0 ? (m_files.size() -failed) /seconds : 0, 'f', 1) <<" images/s\n";
+    const char *names[3] ={"decode", "roi", "caliper"};
+    for(int i =0; i <3; i++){
+        out <<QString("%1  p50 %2  p90 %3  p99 %4  max %5 ms\n").arg(names[i], -8)
+              .arg(percentile(stages[i], 50) /1e6, 0, 'f', 3).arg(percentile(stages[i], 90) /1e6, 0, 'f', 3)
+              .arg(percentile(stages[i], 99) /1e6, 0, 'f', 3).arg(percentile(stages[i], 100) /1e6, 0, 'f', 3);
+    }
+    qint64 peak =peakMemory();
+    if(peak >0)
+        out <<"peak memory: " <<QString::number(peak /1048576.0, 'f', 1) <<" MB\n";
+}
+
+/**
+ * @brief BatchRunner::loadRecipe  后缀为.xml时按XML配方流式读取，否则按二进制配方读取
+ * @param error
+ * @return
+ */
+bool BatchRunner::loadRecipe(QString *error)
+{
+    m_records.clear();
+    bool ok;
+    if(QFileInfo(m_options.recipePath).suffix().toLower() =="xml"){
+        ok =RoiRecipe::readXml(m_options.recipePath, [this](const RoiRecord &record){
+            m_records.push_back(record);
+            return true;
+        }, RoiProgress(), error);
+    }
+    else{
+        ok =RoiRecipe::load(m_options.recipePath, m_records, error);
+    }
+    if(!ok)  return false;
+
+    m_calipers.assign(m_records.size(), CaliperGeometry());
+    RoiQuad quad;
+    for(size_t i =0; i <m_records.size(); i++){
+        const RoiRecord &record =m_records[i];
+        if(record.type !=RoiRecord::ROI_CALIPER)  continue;
+        caliperQuad(QPointF(record.x, record.y), record.width, record.height, record.angle, record.shearAngle, quad);
+        std::copy(quad.begin(), quad.begin() +4, m_calipers[i].vertexes);
+        m_calipers[i].angle =record.angle;
+        m_calipers[i].shearAngle =record.shearAngle;
+    }
+    return true;
+}
+
+/**
+ * @brief BatchRunner::collectFiles  按文件名排序，保证多次运行结果顺序一致
+ */
+void BatchRunner::collectFiles()
+{
+    QStringList filters;
+    for(const char *filter : g_imageFilters)
+        filters <<filter;
+    m_files.clear();
+    QDirIterator it(m_options.inputDir, filters, QDir::Files,
+                    m_options.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while(it.hasNext())
+        m_files <<it.next();
+    m_files.sort();
+}
+
+/**
+ * @brief BatchRunner::decode
+ * 解码线程：依次领取下一个文件，解码为灰度(保留16位)后放入队列，队列满时等待。
+ * 解码失败的图像只记录失败，不进入处理
+ * @param next  共享的文件序号
+ * @param queue
+ */
+void BatchRunner::decode(QAtomicInt &next, BatchQueue<Decoded> &queue)
+{
+    QElapsedTimer timer;
+    for(int index =next.fetchAndAddRelaxed(1); index <m_files.size(); index =next.fetchAndAddRelaxed(1)){
+        timer.start();
+        Decoded item;
+        item.index =index;
+        item.image =cv::imread(m_files.at(index).toLocal8Bit().toStdString(), cv::IMREAD_GRAYSCALE |cv::IMREAD_ANYDEPTH);
+        BatchImageResult &result =m_results[size_t(index)];
+        result.decodeNs =timer.nsecsElapsed();
+        result.loaded =!item.image.empty();
+        if(result.loaded && !queue.push(std::move(item)))  return;
+    }
+}
+
+/**
+ * @brief BatchRunner::writeCsv  每个图像的每个ROI一行
+ * @param out
+ */
+void BatchRunner::writeCsv(QTextStream &out) const
+{
+    out <<"file,roi,type,valid,mean,stddev,min,max,edges,width,score,x1,y1,x2,y2\n";
+    for(int i =0; i <m_files.size(); i++){
+        const BatchImageResult &result =m_results[size_t(i)];
+        QString file =m_files.at(i);
+        file.replace('"', "\"\"");
+        if(!result.loaded){
+            out <<'"' <<file <<"\",-1,load_failed,0,,,,,,,,,,,\n";
+            continue;
+        }
+        for(size_t r =0; r <result.rois.size(); r++){
+            const BatchRoiResult &roi =result.rois[r];
+            out <<'"' <<file <<"\"," <<r <<',' <<typeName(m_records[r].type) <<',' <<int(roi.valid) <<','
+                <<roi.mean <<',' <<roi.stddev <<',' <<roi.minValue <<',' <<roi.maxValue <<','
+                <<roi.edgeCount <<',' <<roi.width <<',' <<roi.score <<','
+                <<roi.first.x() <<',' <<roi.first.y() <<',' <<roi.second.x() <<',' <<roi.second.y() <<'\n';
+        }
+    }
+}
+
+/**
+ * @brief BatchRunner::writeJson  流式写出，不构建整个文档
+ * @param out
+ */
+void BatchRunner::writeJson(QTextStream &out) const
+{
+    out <<"{\n  \"images\": [";
+    for(int i =0; i <m_files.size(); i++){
+        const BatchImageResult &result =m_results[size_t(i)];
+        QString file =m_files.at(i);
+        file.replace('\\', "\\\\").replace('"', "\\\"");
+        out <<(i ? ",\n" : "\n") <<"    {\"file\": \"" <<file <<"\", \"loaded\": " <<(result.loaded ? "true" : "false")
+            <<", \"decodeMs\": " <<result.decodeNs /1e6 <<", \"roiMs\": " <<result.roiNs /1e6
+            <<", \"caliperMs\": " <<result.caliperNs /1e6 <<", \"rois\": [";
+        for(size_t r =0; r <result.rois.size(); r++){
+            const BatchRoiResult &roi =result.rois[r];
+            out <<(r ? ", " : "") <<"{\"type\": \"" <<typeName(m_records[r].type) <<"\", \"valid\": " <<(roi.valid ? "true" : "false");
+            if(m_records[r].type ==RoiRecord::ROI_CALIPER){
+                out <<", \"edges\": " <<roi.edgeCount <<", \"width\": " <<roi.width <<", \"score\": " <<roi.score
+                    <<", \"first\": [" <<roi.first.x() <<", " <<roi.first.y() <<"], \"second\": ["
+                    <<roi.second.x() <<", " <<roi.second.y() <<"]}";
+            }
+            else{
+                out <<", \"mean\": " <<roi.mean <<", \"stddev\": " <<roi.stddev
+                    <<", \"min\": " <<roi.minValue <<", \"max\": " <<roi.maxValue <<"}";
+            }
+        }
+        out <<"]}";
+    }
+    out <<"\n  ],\n  \"elapsedMs\": " <<m_elapsedNs /1e6 <<",\n  \"peakMemory\": " <<peakMemory() <<"\n}\n";
+}
+
+/**
+ * @brief BatchRunner::peakMemory  进程峰值常驻内存(字节)，无法获取时返回0
+ * @return
+ */
+qint64 BatchRunner::peakMemory()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize);
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) !=0)  return 0;
+#ifdef Q_OS_MACOS
+    return qint64(usage.ru_maxrss);
+#else
+    return qint64(usage.ru_maxrss) *1024;
+#endif
+#endif
+}
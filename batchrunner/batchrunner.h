@@ -0,0 +1,154 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+/**
+无界面批处理：对目录中的大量图像执行同一份ROI配方(矩形统计、卡尺测量、点取值)，
+只依赖QtCore，可在没有显示的环境中运行
+**/
+
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QTextStream>
+#include <deque>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "caliper.h"
+#include "roirecipe.h"
+
+/**
+ * @brief The BatchOptions struct  批处理参数
+ */
+struct BatchOptions
+{
+    QString recipePath;         //二进制配方(.roir)或XML配方
+    QString inputDir;
+    bool recursive =false;
+    QString outputPath;         //为空时不写结果
+    bool json =false;           //false为CSV
+    int workers =0;             //处理线程数，0为CPU核数
+    int decoders =2;            //解码线程数
+    int prefetch =8;            //已解码待处理图像的上限，决定内存占用
+    CaliperParams caliper;
+};
+
+/**
+ * @brief The BatchRoiResult struct
+ * 单个ROI在一幅图像上的结果。矩形：mean/stddev/min/max；
+ * 卡尺：边缘数和得分最高的边缘对；点：mean为该像素值
+ */
+struct BatchRoiResult
+{
+    bool valid =false;          //ROI完全在图像外或卡尺未找到边缘对时为false
+    double mean =0;
+    double stddev =0;
+    double minValue =0;
+    double maxValue =0;
+    int edgeCount =0;
+    double width =0;
+    double score =0;
+    QPointF first;
+    QPointF second;
+};
+
+/**
+ * @brief The BatchImageResult struct  单幅图像的结果和各阶段耗时(纳秒)
+ */
+struct BatchImageResult
+{
+    bool loaded =false;
+    qint64 decodeNs =0;
+    qint64 roiNs =0;
+    qint64 caliperNs =0;
+    std::vector<BatchRoiResult> rois;
+};
+
+/**
+ * @brief The BatchQueue class
+ * 有界阻塞队列，满时push等待、空时pop等待；close()后push失败，pop取完剩余元素后返回false
+ */
+template <typename T>
+class BatchQueue
+{
+public:
+    explicit BatchQueue(int capacity) :m_capacity(qMax(1, capacity)), m_closed(false)  {}
+
+    bool push(T &&item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while(!m_closed && int(m_items.size()) >=m_capacity)
+            m_notFull.wait(&m_mutex);
+        if(m_closed)  return false;
+        m_items.push_back(std::move(item));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+    bool pop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while(!m_closed && m_items.empty())
+            m_notEmpty.wait(&m_mutex);
+        if(m_items.empty())  return false;
+        item =std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        return true;
+    }
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed =true;
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    std::deque<T> m_items;
+    int m_capacity;
+    bool m_closed;
+};
+
+/**
+ * @brief The BatchRunner class
+ * 两级有界流水线：解码线程按文件顺序领取任务并解码为灰度图放入队列(预取)，
+ * 处理线程从队列取图执行配方。队列容量限制同时驻留内存的图像数，解码快于处理时解码线程等待。
+ * 每个处理线程为每个卡尺持有一个CaliperEngine，采样网格在图像尺寸不变时只建一次。
+ * 结果按文件顺序写出，统计吞吐量、各阶段耗时百分位和峰值内存
+ */
+class BatchRunner
+{
+public:
+    explicit BatchRunner(const BatchOptions &options);
+
+    bool run(QString *error =nullptr);
+    void report(QTextStream &out) const;
+    int imageCount() const  { return m_files.size();}
+private:
+    struct Decoded
+    {
+        int index;
+        cv::Mat image;
+    };
+    class Worker;
+
+    BatchOptions m_options;
+    std::vector<RoiRecord> m_records;
+    std::vector<CaliperGeometry> m_calipers;   //与m_records对应，非卡尺为空几何
+    QStringList m_files;
+    std::vector<BatchImageResult> m_results;
+    qint64 m_elapsedNs;
+    int m_workerCount;
+
+    bool loadRecipe(QString *error);
+    void collectFiles();
+    void decode(QAtomicInt &next, BatchQueue<Decoded> &queue);
+    void writeCsv(QTextStream &out) const;
+    void writeJson(QTextStream &out) const;
+    static qint64 peakMemory();
+};
+
+#endif // BATCHRUNNER_H
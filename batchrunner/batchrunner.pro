@@ -0,0 +1,25 @@
+QT       -= gui
+QT += concurrent
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = roibatch
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../app
+
+SOURCES += \
+    main.cpp \
+    batchrunner.cpp \
+    ../app/caliper.cpp \
+
+HEADERS += \
+    batchrunner.h \
+    ../app/caliper.h
+
+win32: LIBS += -lpsapi
+
+include(../roicore/roicore.pri)
+include(../opencv.pri)
@@ -0,0 +1,67 @@
+#include "batchrunner.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("roibatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run an ROI recipe over a directory of images without a display.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("recipe", "Binary (.roir) or XML ROI recipe.");
+    parser.addPositionalArgument("images", "Directory of images.");
+    QCommandLineOption outputOption(QStringList() <<"o" <<"output", "Write results to <file>.", "file");
+    QCommandLineOption formatOption("format", "Result format: csv or json (default: from output suffix).", "format");
+    QCommandLineOption recursiveOption(QStringList() <<"r" <<"recursive", "Include subdirectories.");
+    QCommandLineOption workersOption(QStringList() <<"j" <<"workers", "Processing threads (default: CPU count).", "n", "0");
+    QCommandLineOption decodersOption("decoders", "Decoding threads.", "n", "2");
+    QCommandLineOption prefetchOption("prefetch", "Maximum decoded images waiting for processing.", "n", "8");
+    QCommandLineOption thresholdOption("threshold", "Caliper minimum edge strength.", "value", "10");
+    QCommandLineOption sigmaOption("sigma", "Caliper smoothing sigma.", "value", "1");
+    QCommandLineOption polarityOption("polarity", "Caliper first edge polarity: 1, -1 or 0.", "value", "0");
+    QCommandLineOption widthOption("expected-width", "Caliper expected pair width.", "value", "0");
+    parser.addOptions({outputOption, formatOption, recursiveOption, workersOption, decodersOption, prefetchOption,
+                       thresholdOption, sigmaOption, polarityOption, widthOption});
+    parser.process(a);
+
+    QTextStream err(stderr);
+    const QStringList args =parser.positionalArguments();
+    if(args.size() !=2){
+        err <<parser.helpText();
+        return 2;
+    }
+
+    BatchOptions options;
+    options.recipePath =args.at(0);
+    options.inputDir =args.at(1);
+    options.recursive =parser.isSet(recursiveOption);
+    options.outputPath =parser.value(outputOption);
+    QString format =parser.isSet(formatOption) ? parser.value(formatOption).toLower()
+                                               : (options.outputPath.endsWith(".json", Qt::CaseInsensitive) ? "json" : "csv");
+    if(format !="csv" && format !="json"){
+        err <<"unknown format: " <<format <<"\n";
+        return 2;
+    }
+    options.json =format =="json";
+    options.workers =parser.value(workersOption).toInt();
+    options.decoders =parser.value(decodersOption).toInt();
+    options.prefetch =parser.value(prefetchOption).toInt();
+    options.caliper.threshold =parser.value(thresholdOption).toDouble();
+    options.caliper.sigma =parser.value(sigmaOption).toDouble();
+    options.caliper.polarity =parser.value(polarityOption).toInt();
+    options.caliper.expectedWidth =parser.value(widthOption).toDouble();
+
+    BatchRunner runner(options);
+    QString error;
+    if(!runner.run(&error)){
+        err <<"roibatch: " <<error <<"\n";
+        return 1;
+    }
+    QTextStream out(stdout);
+    runner.report(out);
+    return 0;
+}
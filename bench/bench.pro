@@ -0,0 +1,14 @@
+TEMPLATE = subdirs
+
+# 性能基准，均为命令行程序，输出各项耗时
+# convert: 显示通路像素转换内核，1/5/25 MP
+# caliper: 批量卡尺测量，线程数1到CPU核数
+# hittest: RoiHitIndex与逐个judgePosition的按下分派
+# geometry: 卡尺每次移动的几何开销，原多边形算法与roicore内核
+# recipe: 配方往返，QDomDocument、流式XML与二进制
+SUBDIRS += \
+    convert \
+    caliper \
+    hittest \
+    geometry \
+    recipe
@@ -0,0 +1,19 @@
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_caliper
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../../app
+
+SOURCES += \
+    main.cpp \
+    ../../app/caliper.cpp \
+
+HEADERS += \
+    ../../app/caliper.h
+
+include(../../opencv.pri)
@@ -0,0 +1,104 @@
+#include "caliper.h"
+
+#include <cmath>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+
+/**
+批量卡尺测量的线程扩展基准：同一幅图像、同一组卡尺，线程数从1倍增到CPU核数。
+首次调用包含各引擎建立采样网格，之后的调用只做测量；各线程数的结果须与单线程一致
+**/
+
+#define BENCH_IMAGE_SIZE 4096
+#define BENCH_CALIPERS 4000
+#define BENCH_REPEAT 5
+
+/**
+ * @brief makeImage  竖条纹图像，每个卡尺都能检测到若干边缘
+ */
+static cv::Mat makeImage()
+{
+    cv::Mat image(BENCH_IMAGE_SIZE, BENCH_IMAGE_SIZE, CV_8UC1);
+    for(int y =0; y <image.rows; y++){
+        uchar *row =image.ptr<uchar>(y);
+        for(int x =0; x <image.cols; x++)
+            row[x] =((x /23) &1) ? 200 : 40;
+    }
+    return image;
+}
+
+static std::vector<CaliperGeometry> makeGeometries()
+{
+    std::vector<CaliperGeometry> geometries(BENCH_CALIPERS);
+    cv::RNG rng(12345);
+    for(CaliperGeometry &g : geometries){
+        double cx =rng.uniform(200.0, BENCH_IMAGE_SIZE -200.0), cy =rng.uniform(200.0, BENCH_IMAGE_SIZE -200.0);
+        double w =rng.uniform(60.0, 200.0), h =rng.uniform(10.0, 40.0);
+        g.angle =rng.uniform(-0.5, 0.5);
+        double c =std::cos(g.angle), s =std::sin(g.angle);
+        const double corners[4][2] ={{-w /2, -h /2}, {w /2, -h /2}, {w /2, h /2}, {-w /2, h /2}};
+        for(int i =0; i <4; i++)
+            g.vertexes[i] =QPointF(cx +corners[i][0] *c -corners[i][1] *s, cy +corners[i][0] *s +corners[i][1] *c);
+    }
+    return geometries;
+}
+
+static bool sameResults(const std::vector<CaliperResult> &a, const std::vector<CaliperResult> &b)
+{
+    if(a.size() !=b.size())  return false;
+    for(size_t i =0; i <a.size(); i++){
+        if(a[i].edges.size() !=b[i].edges.size() || a[i].pairs.size() !=b[i].pairs.size())  return false;
+        for(size_t k =0; k <a[i].edges.size(); k++){
+            if(a[i].edges[k].position !=b[i].edges[k].position)  return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    cv::Mat image =makeImage();
+    std::vector<CaliperGeometry> geometries =makeGeometries();
+    CaliperParams params;
+    params.maxPairs =4;
+
+    out <<BENCH_CALIPERS <<" calipers on " <<BENCH_IMAGE_SIZE <<"x" <<BENCH_IMAGE_SIZE <<"\n";
+    out <<qSetFieldWidth(10) <<left <<"threads" <<qSetFieldWidth(14) <<"first ms" <<"steady ms"
+        <<"speedup" <<qSetFieldWidth(0) <<"match\n";
+
+    std::vector<CaliperResult> reference;
+    double baseMs =0;
+    bool allMatch =true;
+    const int maxThreads =QThread::idealThreadCount();
+    for(int threads =1; ; threads =qMin(threads *2, maxThreads)){
+        CaliperBatch batch(threads);
+        batch.setParams(params);
+        std::vector<CaliperResult> results;
+        QElapsedTimer timer;
+        timer.start();
+        batch.measure(image, geometries, results);
+        double firstMs =timer.nsecsElapsed() /1e6;
+        double steadyMs =1e30;
+        for(int i =0; i <BENCH_REPEAT; i++){
+            timer.start();
+            batch.measure(image, geometries, results);
+            steadyMs =qMin(steadyMs, timer.nsecsElapsed() /1e6);
+        }
+        if(threads ==1){
+            reference =results;
+            baseMs =steadyMs;
+        }
+        bool match =sameResults(reference, results);
+        allMatch =allMatch && match;
+        out <<qSetFieldWidth(10) <<threads <<qSetFieldWidth(14) <<QString::number(firstMs, 'f', 2)
+            <<QString::number(steadyMs, 'f', 2) <<QString::number(baseMs /steadyMs, 'f', 2)
+            <<qSetFieldWidth(0) <<(match ? "yes" : "NO") <<"\n";
+        if(threads >=maxThreads)  break;
+    }
+    out.flush();
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+QT       += gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_convert
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../../app ../../tests/legacy
+
+SOURCES += \
+    main.cpp \
+    ../../app/pixelconvert.cpp \
+
+HEADERS += \
+    ../../app/pixelconvert.h \
+    ../../tests/legacy/legacyconvert.h
+
+include(../../opencv.pri)
@@ -0,0 +1,101 @@
+#include "pixelconvert.h"
+#include "legacyconvert.h"
+
+#include <cmath>
+#include <cstring>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <opencv2/imgproc/imgproc.hpp>
+
+/**
+显示通路像素转换基准：在1/5/25 MP图像上比较convertPixels、cv::cvtColor和原cvMat2QImage(tests/legacy)：
+RGB888为rgbSwapped()，灰度为每次重建Indexed8调色板加逐行memcpy，RGB32目标在其后再convertToFormat。
+每项取多次运行的最短时间，并校验三者结果逐字节一致
+**/
+
+#define BENCH_REPEAT 10
+
+struct KernelCase
+{
+    PixelKernel kernel;
+    const char *name;
+    int srcType;
+    int dstType;
+    int refCode;    //-1表示参考实现为直接复制
+};
+
+static const KernelCase g_cases[] ={
+    {PIXEL_BGR888_TO_RGB888, "BGR888->RGB888", CV_8UC3, CV_8UC3, cv::COLOR_BGR2RGB},
+    {PIXEL_BGR888_TO_RGB32, "BGR888->RGB32", CV_8UC3, CV_8UC4, cv::COLOR_BGR2BGRA},
+    {PIXEL_GRAY8_TO_GRAY8, "GRAY8->GRAY8", CV_8UC1, CV_8UC1, -1},
+    {PIXEL_GRAY8_TO_RGB32, "GRAY8->RGB32", CV_8UC1, CV_8UC4, cv::COLOR_GRAY2BGRA}
+};
+
+/**
+ * @brief sameRows  QImage与Mat的每行像素字节是否一致
+ */
+static bool sameRows(const QImage &image, const cv::Mat &mat)
+{
+    if(image.width() !=mat.cols || image.height() !=mat.rows)  return false;
+    size_t rowBytes =mat.cols *mat.elemSize();
+    for(int row =0; row <mat.rows; row++){
+        if(std::memcmp(image.constScanLine(row), mat.ptr(row), rowBytes) !=0)  return false;
+    }
+    return true;
+}
+
+template<typename Func>
+static double bestMs(Func func)
+{
+    double best =1e30;
+    QElapsedTimer timer;
+    for(int i =0; i <BENCH_REPEAT; i++){
+        timer.start();
+        func();
+        best =qMin(best, timer.nsecsElapsed() /1e6);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    out <<"kernel level: " <<pixelKernelLevel() <<", threads: " <<cv::getNumThreads() <<"\n";
+    out <<qSetFieldWidth(16) <<left <<"kernel" <<qSetFieldWidth(8) <<"MP" <<qSetFieldWidth(14)
+        <<"convert ms" <<"cvtColor ms" <<"legacy ms" <<"MB/s" <<qSetFieldWidth(0) <<"match\n";
+
+    const int megaPixels[3] ={1, 5, 25};
+    bool allMatch =true;
+    cv::RNG rng(0x5eed);
+    for(int mp : megaPixels){
+        //4:3，宽度不是16的倍数，覆盖SIMD尾部
+        int cols =int(std::sqrt(mp *1e6 *4 /3)) |1;
+        int rows =int(mp *1e6 /cols);
+        for(const KernelCase &c : g_cases){
+            cv::Mat src(rows, cols, c.srcType);
+            rng.fill(src, cv::RNG::UNIFORM, 0, 256);
+            cv::Mat dst(rows, cols, c.dstType), ref;
+            double convertMs =bestMs([&](){ convertPixels(src, dst.data, dst.step, c.kernel);});
+            double refMs =bestMs([&](){
+                if(c.refCode <0)  src.copyTo(ref);
+                else  cv::cvtColor(src, ref, c.refCode);
+            });
+            QImage legacyImage;
+            double legacyMs =bestMs([&](){
+                legacyImage =legacy::cvMat2QImage(src);
+                if(c.dstType ==CV_8UC4)  legacyImage =legacyImage.convertToFormat(QImage::Format_RGB32);
+            });
+            bool match =cv::norm(dst, ref, cv::NORM_INF) ==0 && sameRows(legacyImage, dst);
+            allMatch =allMatch && match;
+            double mb =double(src.total() *src.elemSize() +dst.total() *dst.elemSize()) /(1 <<20);
+            out <<qSetFieldWidth(16) <<c.name <<qSetFieldWidth(8) <<mp <<qSetFieldWidth(14)
+                <<QString::number(convertMs, 'f', 2) <<QString::number(refMs, 'f', 2) <<QString::number(legacyMs, 'f', 2)
+                <<QString::number(mb /(convertMs /1000), 'f', 0) <<qSetFieldWidth(0)
+                <<(match ? "yes" : "NO") <<"\n";
+        }
+    }
+    out.flush();
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+QT       += gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_geometry
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../../tests/legacy
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../tests/legacy/legacygeometry.h
+
+include(../../roicore/roicore.pri)
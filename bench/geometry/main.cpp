@@ -0,0 +1,95 @@
+#include "roishapes.h"
+#include "legacygeometry.h"
+
+#include <random>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/**
+卡尺每次鼠标移动的几何开销：原多边形算法(legacygeometry.h，每步构造多个QPolygonF和QTransform)
+与RoiCaliperShape的参数更新 +重算顶点(CaliperTool在绘制和命中测试前做一次)。
+拖动轨迹预先生成，两者走同一条轨迹
+**/
+
+#define BENCH_MOVES 200000
+
+enum MoveType {MOVE_SCALE, MOVE_ROTATE, MOVE_SHEAR};
+
+struct Move
+{
+    QPointF pos;
+    int corner;
+};
+
+static std::vector<Move> makeTrack(MoveType type, const RoiCaliperShape &start)
+{
+    std::vector<Move> track(BENCH_MOVES);
+    std::mt19937 rng(int(type));
+    std::uniform_real_distribution<qreal> step(-3, 3), angle(-1.2, 1.2);
+    RoiQuad quad;
+    start.quad(quad);
+    for(int i =0; i <BENCH_MOVES; i++){
+        Move &m =track[i];
+        m.corner =(i /1000) %4;
+        if(type ==MOVE_SCALE){
+            m.pos =quad[m.corner] +QPointF(step(rng), step(rng));
+        }
+        else{
+            qreal a =angle(rng) +(type ==MOVE_SHEAR ? 1.5707963 +start.angle : 0);
+            m.pos =start.centre +QPointF(std::cos(a), std::sin(a)) *100;
+        }
+    }
+    return track;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    const RoiCaliperShape start(QPointF(400, 300), 160, 40, 0.3, 0.2);
+    const qreal minCos =std::sin(legacy::g_minAngle *legacy::Pi /180);
+    const char *names[3] ={"scale", "rotate", "shear"};
+
+    out <<qSetFieldWidth(10) <<left <<"move" <<qSetFieldWidth(14) <<"legacy ns" <<"shape ns"
+        <<qSetFieldWidth(0) <<"speedup\n";
+    for(int t =MOVE_SCALE; t <=MOVE_SHEAR; t++){
+        MoveType type =MoveType(t);
+        std::vector<Move> track =makeTrack(type, start);
+        RoiQuad quad;
+        start.quad(quad);
+        legacy::Caliper caliper;
+        for(int i =0; i <5; i++)
+            caliper.m_mainShape <<quad[i];
+        caliper.m_angle =start.angle;
+        caliper.m_shearAngle =start.shearAngle;
+        RoiCaliperShape shape =start;
+
+        QElapsedTimer timer;
+        volatile qreal sink =0;    //防止计算被优化掉
+        timer.start();
+        for(const Move &m : track){
+            if(type ==MOVE_SCALE)  caliper.scale(m.corner +1, m.pos);
+            else if(type ==MOVE_ROTATE)  caliper.rotate(m.pos);
+            else  caliper.shear(m.pos);
+            sink =sink +caliper.m_mainShape[0].x();
+        }
+        double legacyNs =double(timer.nsecsElapsed()) /BENCH_MOVES;
+
+        timer.start();
+        for(const Move &m : track){
+            if(type ==MOVE_SCALE)  shape.dragCorner(m.corner, m.pos, legacy::g_minLen, legacy::g_minLen /2);
+            else if(type ==MOVE_ROTATE)  shape.rotateTowards(m.pos);
+            else  shape.shearTowards(m.pos, minCos);
+            shape.quad(quad);
+            sink =sink +quad[0].x();
+        }
+        double shapeNs =double(timer.nsecsElapsed()) /BENCH_MOVES;
+
+        out <<qSetFieldWidth(10) <<names[t] <<qSetFieldWidth(14) <<QString::number(legacyNs, 'f', 1)
+            <<QString::number(shapeNs, 'f', 1) <<qSetFieldWidth(0) <<QString::number(legacyNs /shapeNs, 'f', 1)
+            <<"x\n";
+    }
+    out.flush();
+    return 0;
+}
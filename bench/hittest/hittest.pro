@@ -0,0 +1,25 @@
+QT       += core gui widgets xml
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_hittest
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../../app ../../tests/legacy
+
+SOURCES += \
+    main.cpp \
+    ../../app/simpleroi.cpp \
+    ../../app/roihitindex.cpp \
+    ../../app/caliper.cpp \
+
+HEADERS += \
+    ../../app/simpleroi.h \
+    ../../app/roihitindex.h \
+    ../../app/caliper.h \
+    ../../tests/legacy/legacygeometry.h
+
+include(../../roicore/roicore.pri)
+include(../../opencv.pri)
@@ -0,0 +1,197 @@
+#include "simpleroi.h"
+#include "roihitindex.h"
+#include "legacygeometry.h"
+
+#include <cmath>
+#include <random>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/**
+ROI命中测试基准：场景中放置N个SimpleROI和CaliperTool(各占一半，Z值各不相同)，比较三种按下分派方式：
+原实现逐个图形判定(线性扫描)、QGraphicsScene::items取光标下图形后逐个判定，以及RoiHitIndex::hitTest。
+前两列用tests/legacy中的原实现legacy::rectRegion和legacy::Caliper::judgePosition(图形坐标的整数矩形和多边形)。
+agree列核对索引与逐个调用hitRegion的线性扫描选中的图形和区域：hitRegion与按下时的judgePosition是同一判定，
+索引只用图元找出候选再由hitRegion确认，所以必须完全一致，否则返回非0。
+无显示环境下加 -platform offscreen 运行
+**/
+
+#define BENCH_TOLERANCE 5       //与SimpleROI、CaliperTool的SHAPE_CONTROL_SIZE一致
+#define BENCH_SCENE_SIZE 20000
+#define BENCH_PROBES 20000
+
+struct BenchItem
+{
+    QGraphicsObject *item;
+    SimpleROI *rect;
+    RoiQuad quad;               //卡尺的场景坐标顶点，用于生成探测点
+    QRect legacyRect;           //原SimpleROI的整数矩形(图形坐标)
+    legacy::Caliper legacyCaliper;  //原CaliperTool的多边形(图形坐标)
+};
+
+/**
+ * @brief legacyJudge  原实现的judgePosition，返回类型(0控制点，1边，2内部，3未命中)
+ */
+static int legacyJudge(const BenchItem &b, const QPointF &scenePos)
+{
+    QPointF pos =b.item->mapFromScene(scenePos);
+    if(b.rect){
+        int region =legacy::rectRegion(b.legacyRect, pos, BENCH_TOLERANCE);
+        if(region ==RoiRectShape::OUTSIDE)  return 3;
+        if(region ==RoiRectShape::INSIDE)  return 2;
+        return region >=RoiRectShape::TOPLEFT ? 0 : 1;
+    }
+    int region =b.legacyCaliper.judgePosition(pos, BENCH_TOLERANCE);
+    if(region ==RoiCaliperShape::NONE)  return 3;
+    return region <=RoiCaliperShape::BOTTOMMIDDLE ? 0 : 1;
+}
+
+/**
+ * @brief judge  图形自己的区域判定，返回类型(0控制点，1边，2内部，3未命中)
+ */
+static int judge(const BenchItem &b, const QPointF &scenePos, int &region)
+{
+    RoiHitShape::ShapeType type;
+    if(!dynamic_cast<RoiHitTarget*>(b.item)->hitRegion(scenePos, type, region))  return 3;
+    return type ==RoiHitShape::HIT_BOX ? 0 : type;
+}
+
+/**
+ * @brief legacyLinearHit  原实现：逐个图形判定，控制点 >边 >内部，同级取Z值高的
+ */
+static QGraphicsObject* legacyLinearHit(const std::vector<BenchItem> &items, const QPointF &scenePos)
+{
+    QGraphicsObject *best =nullptr;
+    int bestType =3;
+    qreal bestZ =0;
+    for(const BenchItem &b : items){
+        int type =legacyJudge(b, scenePos);
+        if(type >bestType || (type ==bestType && (type ==3 || b.item->zValue() <=bestZ)))  continue;
+        best =b.item;
+        bestType =type;
+        bestZ =b.item->zValue();
+    }
+    return best;
+}
+
+/**
+ * @brief linearHit  与索引相同的优先级逐个调用hitRegion，作为索引结果的参照
+ */
+static RoiHit linearHit(const std::vector<BenchItem> &items, const QPointF &scenePos)
+{
+    RoiHit best;
+    int bestType =3;
+    qreal bestZ =0;
+    for(const BenchItem &b : items){
+        int region;
+        int type =judge(b, scenePos, region);
+        if(type >bestType || (type ==bestType && (type ==3 || b.item->zValue() <=bestZ)))  continue;
+        best.item =b.item;
+        best.region =region;
+        bestType =type;
+        bestZ =b.item->zValue();
+    }
+    return best;
+}
+
+/**
+ * @brief legacySceneHit  Qt的分派方式：按Z值从高到低取外接矩形包含光标的图形，第一个原实现判定命中的接收
+ */
+static QGraphicsObject* legacySceneHit(QGraphicsScene &scene, const QHash<QGraphicsItem*, int> &lookup,
+                                       const std::vector<BenchItem> &items, const QPointF &scenePos)
+{
+    const QList<QGraphicsItem*> under =scene.items(scenePos, Qt::IntersectsItemBoundingRect, Qt::DescendingOrder);
+    for(QGraphicsItem *item : under){
+        const BenchItem &b =items[lookup.value(item)];
+        if(legacyJudge(b, scenePos) <3)  return b.item;
+    }
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+    QTextStream out(stdout);
+    out <<qSetFieldWidth(8) <<left <<"items" <<qSetFieldWidth(20) <<"legacy linear ns" <<"legacy scene ns"
+        <<"index ns" <<qSetFieldWidth(0) <<"agree\n";
+
+    bool failed =false;
+    const int counts[3] ={100, 1000, 5000};
+    for(int n : counts){
+        QGraphicsScene scene;
+        RoiHitIndex *index =RoiHitIndex::forScene(&scene);
+        std::vector<BenchItem> items;
+        QHash<QGraphicsItem*, int> lookup;
+        std::mt19937 rng(n);
+        std::uniform_real_distribution<qreal> pos(0, BENCH_SCENE_SIZE), size(30, 300), angle(-1.5, 1.5), shear(-0.5, 0.5);
+        for(int i =0; i <n; i++){
+            BenchItem b;
+            b.rect =nullptr;
+            if(i %2 ==0){
+                b.rect =new SimpleROI;
+                b.rect->setRect(QRect(0, 0, int(size(rng)), int(size(rng))));
+                b.item =b.rect;
+            }
+            else{
+                CaliperTool *caliper =new CaliperTool;
+                caliper->setShape(QPointF(0, 0), size(rng), size(rng) /3, angle(rng), shear(rng));
+                b.item =caliper;
+            }
+            b.item->setPos(pos(rng), pos(rng));
+            b.item->setZValue(i);
+            scene.addItem(b.item);
+            index->addItem(b.item);
+            if(b.rect){
+                b.legacyRect =b.rect->getRect();
+            }
+            else{
+                const RoiCaliperShape &shape =static_cast<CaliperTool*>(b.item)->caliperShape();
+                shape.quad(b.quad);
+                for(int k =0; k <5; k++)  b.legacyCaliper.m_mainShape <<b.quad[k];
+                b.legacyCaliper.m_angle =shape.angle;
+                b.legacyCaliper.m_shearAngle =shape.shearAngle;
+                for(int k =0; k <5; k++)  b.quad[k] =b.item->mapToScene(b.quad[k]);
+            }
+            lookup.insert(b.item, i);
+            items.push_back(b);
+        }
+
+        //一半探测点落在图形的顶点附近，一半均匀分布
+        std::vector<QPointF> probes(BENCH_PROBES);
+        std::uniform_real_distribution<qreal> jitter(-8, 8);
+        for(int i =0; i <BENCH_PROBES; i++){
+            if(i %2){
+                probes[i] =QPointF(pos(rng), pos(rng));
+                continue;
+            }
+            const BenchItem &b =items[rng() %n];
+            QPointF v =b.rect ? b.item->mapToScene(b.rect->getRectF().topLeft()) : b.quad[rng() %4];
+            probes[i] =v +QPointF(jitter(rng), jitter(rng));
+        }
+
+        index->hitTest(probes[0]);    //首次查询建立索引
+        QElapsedTimer timer;
+        int agree =0;
+        volatile quintptr sink =0;    //防止查询被优化掉
+        timer.start();
+        for(const QPointF &p : probes)  sink =sink +quintptr(legacyLinearHit(items, p));
+        double linearNs =double(timer.nsecsElapsed()) /BENCH_PROBES;
+        timer.start();
+        for(const QPointF &p : probes)  sink =sink +quintptr(legacySceneHit(scene, lookup, items, p));
+        double sceneNs =double(timer.nsecsElapsed()) /BENCH_PROBES;
+        timer.start();
+        for(const QPointF &p : probes)  sink =sink +quintptr(index->hitTest(p).item);
+        double indexNs =double(timer.nsecsElapsed()) /BENCH_PROBES;
+        for(const QPointF &p : probes){
+            RoiHit expected =linearHit(items, p), hit =index->hitTest(p);
+            if(hit.item ==expected.item && (!hit.item || hit.region ==expected.region))  agree++;
+        }
+        if(agree !=BENCH_PROBES)  failed =true;
+        out <<qSetFieldWidth(8) <<n <<qSetFieldWidth(20) <<QString::number(linearNs, 'f', 0)
+            <<QString::number(sceneNs, 'f', 0) <<QString::number(indexNs, 'f', 0) <<qSetFieldWidth(0)
+            <<QString::number(100.0 *agree /BENCH_PROBES, 'f', 2) <<"%\n";
+    }
+    out.flush();
+    return failed ? 1 : 0;
+}
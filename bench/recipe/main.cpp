@@ -0,0 +1,169 @@
+#include "roirecipe.h"
+
+#include <cstring>
+#include <random>
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+/**
+ROI配方往返基准：同一组记录分别经QDomDocument(原保存方式，整棵文档树)、流式XML(RoiRecipe::saveXml/readXml)
+和二进制(RoiRecipe::save/load，以及只映射不复制的map)写出再读回，统计耗时和文件大小，并校验读回的记录与原记录逐字节一致
+**/
+
+static const char* tagName(quint32 type)
+{
+    return type ==RoiRecord::ROI_CALIPER ? "CaliperTool" : (type ==RoiRecord::ROI_POINT ? "SimpleMovablePoint" : "SimpleROI");
+}
+
+static std::vector<RoiRecord> makeRecords(int n)
+{
+    std::vector<RoiRecord> records(n);
+    std::mt19937 rng(n);
+    std::uniform_real_distribution<double> pos(0, 20000), size(10, 400), angle(-3, 3);
+    for(int i =0; i <n; i++){
+        RoiRecord &r =records[i];
+        r.type =quint32(RoiRecord::ROI_RECT +i %3);
+        r.flags =(r.type ==RoiRecord::ROI_RECT && i %2) ? RoiRecord::FLAG_SUBPIXEL : 0;
+        r.x =pos(rng);
+        r.y =pos(rng);
+        if(r.type ==RoiRecord::ROI_POINT)  continue;
+        r.width =size(rng);
+        r.height =size(rng);
+        if(r.type ==RoiRecord::ROI_CALIPER){
+            r.angle =angle(rng);
+            r.shearAngle =angle(rng) /4;
+        }
+    }
+    return records;
+}
+
+static bool sameRecords(const std::vector<RoiRecord> &a, const RoiRecord *b, size_t count)
+{
+    return a.size() ==count && (count ==0 || std::memcmp(a.data(), b, count *sizeof(RoiRecord)) ==0);
+}
+
+static void addElementWithText(QDomDocument &document, QDomElement &parent, const QString &tagName, double value)
+{
+    QDomElement elem =document.createElement(tagName);
+    elem.appendChild(document.createTextNode(QString::number(value, 'g', 17)));
+    parent.appendChild(elem);
+}
+
+/**
+ * @brief saveDom  原保存方式：在内存中建好整棵文档树后一次写出
+ */
+static bool saveDom(const QString &path, const std::vector<RoiRecord> &records)
+{
+    QDomDocument document;
+    QDomElement root =document.createElement("RoiRecipe");
+    document.appendChild(root);
+    for(const RoiRecord &r : records){
+        QDomElement elem =document.createElement(tagName(r.type));
+        if(r.flags &RoiRecord::FLAG_SUBPIXEL)  elem.setAttribute("subPixel", "1");
+        addElementWithText(document, elem, "x", r.x);
+        addElementWithText(document, elem, "y", r.y);
+        if(r.type !=RoiRecord::ROI_POINT){
+            addElementWithText(document, elem, "width", r.width);
+            addElementWithText(document, elem, "height", r.height);
+        }
+        if(r.type ==RoiRecord::ROI_CALIPER){
+            addElementWithText(document, elem, "angle", r.angle);
+            addElementWithText(document, elem, "shearAngle", r.shearAngle);
+        }
+        root.appendChild(elem);
+    }
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))  return false;
+    return file.write(document.toByteArray()) >=0;
+}
+
+static bool loadDom(const QString &path, std::vector<RoiRecord> &records)
+{
+    QFile file(path);
+    QDomDocument document;
+    if(!file.open(QIODevice::ReadOnly) || !document.setContent(&file))  return false;
+    records.clear();
+    for(QDomElement elem =document.documentElement().firstChildElement(); !elem.isNull(); elem =elem.nextSiblingElement()){
+        RoiRecord r;
+        QString tag =elem.tagName();
+        r.type =tag =="CaliperTool" ? RoiRecord::ROI_CALIPER : (tag =="SimpleMovablePoint" ? RoiRecord::ROI_POINT : RoiRecord::ROI_RECT);
+        r.flags =elem.attribute("subPixel") =="1" ? RoiRecord::FLAG_SUBPIXEL : 0;
+        r.x =elem.firstChildElement("x").text().toDouble();
+        r.y =elem.firstChildElement("y").text().toDouble();
+        r.width =elem.firstChildElement("width").text().toDouble();
+        r.height =elem.firstChildElement("height").text().toDouble();
+        r.angle =elem.firstChildElement("angle").text().toDouble();
+        r.shearAngle =elem.firstChildElement("shearAngle").text().toDouble();
+        records.push_back(r);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    QTemporaryDir dir;
+    if(!dir.isValid()){
+        out <<"cannot create temporary directory\n";
+        return 1;
+    }
+    out <<qSetFieldWidth(8) <<left <<"ROIs" <<qSetFieldWidth(10) <<"format" <<qSetFieldWidth(12) <<"save ms"
+        <<"load ms" <<"size KB" <<qSetFieldWidth(0) <<"match\n";
+
+    bool allMatch =true;
+    auto report =[&](int n, const char *format, double saveMs, double loadMs, const QString &path, bool match){
+        allMatch =allMatch && match;
+        out <<qSetFieldWidth(8) <<n <<qSetFieldWidth(10) <<format <<qSetFieldWidth(12)
+            <<QString::number(saveMs, 'f', 2) <<QString::number(loadMs, 'f', 2)
+            <<QString::number(QFileInfo(path).size() /1024) <<qSetFieldWidth(0) <<(match ? "yes" : "NO") <<"\n";
+    };
+
+    const int counts[3] ={1000, 10000, 100000};
+    for(int n : counts){
+        const std::vector<RoiRecord> records =makeRecords(n);
+        std::vector<RoiRecord> loaded;
+        QElapsedTimer timer;
+
+        QString domPath =dir.filePath("dom.xml");
+        timer.start();
+        bool ok =saveDom(domPath, records);
+        double saveMs =timer.nsecsElapsed() /1e6;
+        timer.start();
+        ok =ok && loadDom(domPath, loaded);
+        report(n, "DOM", saveMs, timer.nsecsElapsed() /1e6, domPath, ok && sameRecords(records, loaded.data(), loaded.size()));
+
+        QString xmlPath =dir.filePath("stream.xml");
+        timer.start();
+        ok =RoiRecipe::saveXml(xmlPath, records);
+        saveMs =timer.nsecsElapsed() /1e6;
+        timer.start();
+        loaded.clear();
+        ok =ok && RoiRecipe::readXml(xmlPath, [&loaded](const RoiRecord &record){
+            loaded.push_back(record);
+            return true;
+        });
+        report(n, "XML", saveMs, timer.nsecsElapsed() /1e6, xmlPath, ok && sameRecords(records, loaded.data(), loaded.size()));
+
+        QString binPath =dir.filePath("recipe.roir");
+        timer.start();
+        ok =RoiRecipe::save(binPath, records);
+        saveMs =timer.nsecsElapsed() /1e6;
+        timer.start();
+        ok =ok && RoiRecipe::load(binPath, loaded);
+        report(n, "binary", saveMs, timer.nsecsElapsed() /1e6, binPath, ok && sameRecords(records, loaded.data(), loaded.size()));
+
+        RoiRecipe recipe;
+        timer.start();
+        ok =recipe.map(binPath);
+        double mapMs =timer.nsecsElapsed() /1e6;
+        report(n, "mapped", 0, mapMs, binPath, ok && sameRecords(records, recipe.records(), size_t(recipe.count())));
+        recipe.close();
+    }
+    out.flush();
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+QT       -= gui
+QT += xml
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_recipe
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    main.cpp
+
+include(../../roicore/roicore.pri)
@@ -0,0 +1,3 @@
+# OpenCV路径，主程序和批处理程序共用
+INCLUDEPATH +=D:\opencv\build-forQt\install\include
+LIBS +=D:\opencv\build-forQt\lib\libopencv_*.a
@@ -0,0 +1,12 @@
+# 链接roicore静态库，库的构建目录由本文件位置得到，任意层级的子工程(app、bench、tests下)都可包含
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+ROICORE_OUT = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): ROICORE_DIR = $$ROICORE_OUT/release
+else:win32:CONFIG(debug, debug|release): ROICORE_DIR = $$ROICORE_OUT/debug
+else: ROICORE_DIR = $$ROICORE_OUT
+
+LIBS += -L$$ROICORE_DIR -lroicore
+win32-msvc*: PRE_TARGETDEPS += $$ROICORE_DIR/roicore.lib
+else: PRE_TARGETDEPS += $$ROICORE_DIR/libroicore.a
@@ -0,0 +1,17 @@
+TEMPLATE = lib
+CONFIG += staticlib c++11
+QT = core
+
+TARGET = roicore
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    spatialgrid.cpp \
+    roirecipe.cpp
+
+HEADERS += \
+    roigeometry.h \
+    roishapes.h \
+    spatialgrid.h \
+    roirecipe.h
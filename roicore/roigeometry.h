@@ -0,0 +1,187 @@
+#ifndef ROIGEOMETRY_H
+#define ROIGEOMETRY_H
+
+/**
+ROI几何计算内核，只依赖QtCore：正余弦预先计算，四边形为定长数组原地变换，无堆分配，不抛异常
+**/
+
+#include <QPointF>
+#include <QRectF>
+#include <array>
+#include <cmath>
+
+/**
+ * @brief RoiQuad  闭合四边形，[4]与[0]相同，顶点顺序为左上、右上、右下、左下
+ */
+typedef std::array<QPointF, 5> RoiQuad;
+
+/**
+ * @brief The SinCos struct  角度的正余弦，同一角度作用于多个点时只计算一次
+ */
+struct SinCos
+{
+    qreal s;
+    qreal c;
+    SinCos() noexcept :s(0), c(1)  {}
+    explicit SinCos(qreal angle) noexcept :s(std::sin(angle)), c(std::cos(angle))  {}
+    SinCos inverse() const noexcept  { SinCos r; r.s =-s; r.c =c; return r;}
+};
+
+/**
+ * @brief The RoiAffine struct
+ * 二维仿射变换，系数约定与QTransform相同：x' =m11*x +m21*y +dx，y' =m12*x +m22*y +dy
+ */
+struct RoiAffine
+{
+    qreal m11, m12, m21, m22, dx, dy;
+
+    RoiAffine() noexcept :m11(1), m12(0), m21(0), m22(1), dx(0), dy(0)  {}
+
+    QPointF map(const QPointF &p) const noexcept
+    {
+        return QPointF(m11 *p.x() +m21 *p.y() +dx, m12 *p.x() +m22 *p.y() +dy);
+    }
+
+    /**
+     * @brief inverted  行列式为0时返回单位变换
+     */
+    RoiAffine inverted() const noexcept
+    {
+        RoiAffine r;
+        qreal det =m11 *m22 -m12 *m21;
+        if(det ==0)  return r;
+        qreal inv =1 /det;
+        r.m11 =m22 *inv;
+        r.m12 =-m12 *inv;
+        r.m21 =-m21 *inv;
+        r.m22 =m11 *inv;
+        r.dx =-(r.m11 *dx +r.m21 *dy);
+        r.dy =-(r.m12 *dx +r.m22 *dy);
+        return r;
+    }
+
+    /**
+     * @brief rotateShear
+     * 旋转∘倾斜的合成线性部分：把轴对齐矩形的x轴映射到旋转角方向，y轴映射到旋转角+倾斜角方向，
+     * 边长保持不变，即卡尺从矩形空间到图形的变换
+     * @param angle  旋转角的正余弦
+     * @param edgeAngle  旋转角+倾斜角的正余弦
+     */
+    static RoiAffine rotateShear(const SinCos &angle, const SinCos &edgeAngle) noexcept
+    {
+        RoiAffine r;
+        r.m11 =angle.c;
+        r.m12 =angle.s;
+        r.m21 =-edgeAngle.s;
+        r.m22 =edgeAngle.c;
+        return r;
+    }
+};
+
+/**
+ * @brief roiSquaredDistance  两点距离的平方
+ */
+inline qreal roiSquaredDistance(const QPointF &p, const QPointF &q) noexcept
+{
+    qreal dx =p.x() -q.x(), dy =p.y() -q.y();
+    return dx *dx +dy *dy;
+}
+
+/**
+ * @brief roiSquaredSegmentDistance  点到线段AB距离的平方，无开方
+ */
+inline qreal roiSquaredSegmentDistance(const QPointF &p, const QPointF &a, const QPointF &b) noexcept
+{
+    qreal ex =b.x() -a.x(), ey =b.y() -a.y();
+    qreal px =p.x() -a.x(), py =p.y() -a.y();
+    qreal len2 =ex *ex +ey *ey;
+    qreal t =len2 >0 ? (px *ex +py *ey) /len2 : 0;
+    t =t <0 ? 0 : (t >1 ? 1 : t);
+    qreal dx =px -t *ex, dy =py -t *ey;
+    return dx *dx +dy *dy;
+}
+
+/**
+ * @brief caliperQuad
+ * 由参数得到卡尺闭合顶点：中心 +旋转∘倾斜(±宽/2, ±高/2)
+ * @param centre
+ * @param width  上边长
+ * @param height  左边长
+ * @param angle  旋转角(弧度)
+ * @param shearAngle  倾斜角(弧度)
+ * @param quad  输出
+ */
+inline void caliperQuad(const QPointF &centre, qreal width, qreal height, qreal angle, qreal shearAngle, RoiQuad &quad) noexcept
+{
+    RoiAffine toShape =RoiAffine::rotateShear(SinCos(angle), SinCos(angle +shearAngle));
+    toShape.dx =centre.x();
+    toShape.dy =centre.y();
+    qreal hw =width /2, hh =height /2;
+    quad[0] =toShape.map(QPointF(-hw, -hh));
+    quad[1] =toShape.map(QPointF(hw, -hh));
+    quad[2] =toShape.map(QPointF(hw, hh));
+    quad[3] =toShape.map(QPointF(-hw, hh));
+    quad[4] =quad[0];
+}
+
+/**
+ * @brief rotatePoint  pt绕center旋转
+ */
+inline QPointF rotatePoint(const QPointF &pt, const QPointF &center, const SinCos &sc) noexcept
+{
+    qreal x =pt.x() -center.x(), y =pt.y() -center.y();
+    return QPointF(center.x() +x *sc.c -y *sc.s, center.y() +x *sc.s +y *sc.c);
+}
+
+/**
+ * @brief rotateQuad  四边形绕center原地旋转
+ */
+inline void rotateQuad(RoiQuad &quad, const QPointF &center, const SinCos &sc) noexcept
+{
+    for(int i =0; i <4; i++)
+        quad[i] =rotatePoint(quad[i], center, sc);
+    quad[4] =quad[0];
+}
+
+/**
+ * @brief shearQuad  原地倾斜：左右两边分别绕各自中点旋转，上下边中线不变
+ */
+inline void shearQuad(RoiQuad &quad, const SinCos &sc) noexcept
+{
+    QPointF lmid =(quad[0] +quad[3]) /2;
+    QPointF rmid =(quad[1] +quad[2]) /2;
+    quad[0] =rotatePoint(quad[0], lmid, sc);
+    quad[1] =rotatePoint(quad[1], rmid, sc);
+    quad[2] =rotatePoint(quad[2], rmid, sc);
+    quad[3] =rotatePoint(quad[3], lmid, sc);
+    quad[4] =quad[0];
+}
+
+inline void translateQuad(RoiQuad &quad, qreal dx, qreal dy) noexcept
+{
+    QPointF delta(dx, dy);
+    for(int i =0; i <5; i++)
+        quad[i] +=delta;
+}
+
+/**
+ * @brief quadCentre  两条对角线中点的平均
+ */
+inline QPointF quadCentre(const RoiQuad &quad) noexcept
+{
+    return ((quad[0] +quad[2]) /2 +(quad[1] +quad[3]) /2) /2;
+}
+
+inline QRectF quadBounds(const RoiQuad &quad) noexcept
+{
+    qreal left =quad[0].x(), right =left, top =quad[0].y(), bottom =top;
+    for(int i =1; i <4; i++){
+        left =qMin(left, quad[i].x());
+        right =qMax(right, quad[i].x());
+        top =qMin(top, quad[i].y());
+        bottom =qMax(bottom, quad[i].y());
+    }
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
+#endif // ROIGEOMETRY_H
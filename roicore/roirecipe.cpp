@@ -0,0 +1,345 @@
+#include "roirecipe.h"
+
+#include <climits>
+#include <cstring>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+static const char g_recipeMagic[8] ={'R', 'O', 'I', 'R', 'C', 'P', '\0', '\0'};
+static const quint32 g_byteOrderMark =0x01020304;
+
+static void setError(QString *error, const QString &message)
+{
+    if(error)  *error =message;
+}
+
+/**
+ * @brief xmlTagName  XML配方中各类型ROI的元素名，与图形类名一致
+ */
+static QLatin1String xmlTagName(quint32 type)
+{
+    switch (type) {
+    case RoiRecord::ROI_CALIPER:
+        return QLatin1String("CaliperTool");
+    case RoiRecord::ROI_POINT:
+        return QLatin1String("SimpleMovablePoint");
+    default:
+        return QLatin1String("SimpleROI");
+    }
+}
+
+//class RoiRecipe  二进制ROI配方
+
+RoiRecipe::RoiRecipe() :m_data(nullptr), m_records(nullptr), m_count(0)
+{
+
+}
+
+RoiRecipe::~RoiRecipe()
+{
+    close();
+}
+
+/**
+ * @brief RoiRecipe::save  先写临时文件，成功后替换，写入中断不会破坏原配方
+ * @param path
+ * @param records
+ * @param error
+ * @return
+ */
+bool RoiRecipe::save(const QString &path, const std::vector<RoiRecord> &records, QString *error)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)){
+        setError(error, file.errorString());
+        return false;
+    }
+    RoiRecipeHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, g_recipeMagic, sizeof(header.magic));
+    header.byteOrder =g_byteOrderMark;
+    header.version =VERSION;
+    header.headerSize =sizeof(RoiRecipeHeader);
+    header.recordSize =sizeof(RoiRecord);
+    header.count =quint32(records.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if(!records.empty())
+        file.write(reinterpret_cast<const char*>(records.data()), qint64(records.size() *sizeof(RoiRecord)));
+    if(!file.commit()){
+        setError(error, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::load  映射文件后一次复制全部记录
+ * @param path
+ * @param records  输出
+ * @param error
+ * @return
+ */
+bool RoiRecipe::load(const QString &path, std::vector<RoiRecord> &records, QString *error)
+{
+    RoiRecipe recipe;
+    if(!recipe.map(path, error))  return false;
+    records.assign(recipe.records(), recipe.records() +recipe.count());
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::importXml
+ * 流式导入旧版XML配方：任意元素下同时含有x、y、width、height四个子元素时视为一个矩形ROI，
+ * 子元素顺序不限，数值可为小数；不构建DOM，内存占用与文件大小无关
+ * @param path
+ * @param records  导入的记录追加到末尾
+ * @param error
+ * @return
+ */
+bool RoiRecipe::importXml(const QString &path, std::vector<RoiRecord> &records, QString *error)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)){
+        setError(error, file.errorString());
+        return false;
+    }
+    struct Pending
+    {
+        RoiRecord record;
+        int fields;
+    };
+    std::vector<Pending> stack;
+    QXmlStreamReader reader(&file);
+    while(!reader.atEnd()){
+        QXmlStreamReader::TokenType token =reader.readNext();
+        if(token ==QXmlStreamReader::StartElement){
+            QStringRef name =reader.name();
+            int field =name ==QLatin1String("x") ? 0 : name ==QLatin1String("y") ? 1
+                      : name ==QLatin1String("width") ? 2 : name ==QLatin1String("height") ? 3 : -1;
+            if(field >=0 && !stack.empty()){
+                double value =reader.readElementText(QXmlStreamReader::SkipChildElements).toDouble();
+                Pending &parent =stack.back();
+                double *dst[4] ={&parent.record.x, &parent.record.y, &parent.record.width, &parent.record.height};
+                *dst[field] =value;
+                parent.fields |=1 <<field;
+                continue;
+            }
+            Pending pending;
+            pending.fields =0;
+            stack.push_back(pending);
+        }
+        else if(token ==QXmlStreamReader::EndElement && !stack.empty()){
+            if(stack.back().fields ==0xf){
+                RoiRecord record =stack.back().record;
+                record.type =RoiRecord::ROI_RECT;
+                records.push_back(record);
+            }
+            stack.pop_back();
+        }
+    }
+    if(reader.hasError()){
+        setError(error, reader.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::saveXml  流式写出XML配方，根元素为RoiRecipe
+ * @param path
+ * @param records
+ * @param error
+ * @return
+ */
+bool RoiRecipe::saveXml(const QString &path, const std::vector<RoiRecord> &records, QString *error)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)){
+        setError(error, file.errorString());
+        return false;
+    }
+    QXmlStreamWriter writer(&file);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("RoiRecipe");
+    writer.writeAttribute("version", QString::number(VERSION));
+    for(const RoiRecord &record : records)
+        writeXmlRecord(writer, record);
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    if(writer.hasError() || !file.commit()){
+        setError(error, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::readXml
+ * 流式读取XML配方，每读完一个ROI元素立即回调handler，调用方可随即创建图形；
+ * 不认识的元素连同子元素跳过
+ * @param path
+ * @param handler  返回false时停止读取，此时返回值仍为true
+ * @param progress  每个ROI之后报告已读字节数，可为空
+ * @param error
+ * @return  文件无法打开或XML格式错误时返回false
+ */
+bool RoiRecipe::readXml(const QString &path, const RoiRecordHandler &handler, const RoiProgress &progress, QString *error)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)){
+        setError(error, file.errorString());
+        return false;
+    }
+    qint64 total =file.size();
+    QXmlStreamReader reader(&file);
+    int depth =0;
+    while(!reader.atEnd()){
+        QXmlStreamReader::TokenType token =reader.readNext();
+        if(token ==QXmlStreamReader::EndElement){
+            depth--;
+            continue;
+        }
+        if(token !=QXmlStreamReader::StartElement)  continue;
+        if(depth ==0){
+            depth++;
+            continue;
+        }
+        RoiRecord record;
+        if(!readXmlRecord(reader, record)){
+            reader.skipCurrentElement();
+            continue;
+        }
+        if(progress)  progress(file.pos(), total);
+        if(!handler(record))  break;
+    }
+    if(reader.hasError()){
+        setError(error, QString("RoiRecipe: line %1: %2").arg(reader.lineNumber()).arg(reader.errorString()));
+        return false;
+    }
+    if(progress)  progress(total, total);
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::writeXmlRecord  写出一个ROI元素，几何为子元素，亚像素标志为属性
+ * @param writer
+ * @param record
+ */
+void RoiRecipe::writeXmlRecord(QXmlStreamWriter &writer, const RoiRecord &record)
+{
+    writer.writeStartElement(xmlTagName(record.type));
+    if(record.flags &RoiRecord::FLAG_SUBPIXEL)
+        writer.writeAttribute("subPixel", "1");
+    writer.writeTextElement("x", QString::number(record.x, 'g', 17));
+    writer.writeTextElement("y", QString::number(record.y, 'g', 17));
+    if(record.type ==RoiRecord::ROI_POINT){
+        writer.writeEndElement();
+        return;
+    }
+    writer.writeTextElement("width", QString::number(record.width, 'g', 17));
+    writer.writeTextElement("height", QString::number(record.height, 'g', 17));
+    if(record.type ==RoiRecord::ROI_CALIPER){
+        writer.writeTextElement("angle", QString::number(record.angle, 'g', 17));
+        writer.writeTextElement("shearAngle", QString::number(record.shearAngle, 'g', 17));
+    }
+    writer.writeEndElement();
+}
+
+/**
+ * @brief RoiRecipe::readXmlRecord
+ * 读取一个ROI元素，reader须位于该元素的StartElement，返回时位于其EndElement。
+ * 子元素顺序不限，缺省的字段为0，不认识的子元素跳过
+ * @param reader
+ * @param record  输出
+ * @return  元素名不是ROI类型时返回false，reader不移动
+ */
+bool RoiRecipe::readXmlRecord(QXmlStreamReader &reader, RoiRecord &record)
+{
+    QStringRef name =reader.name();
+    if(name ==xmlTagName(RoiRecord::ROI_RECT))  record.type =RoiRecord::ROI_RECT;
+    else if(name ==xmlTagName(RoiRecord::ROI_CALIPER))  record.type =RoiRecord::ROI_CALIPER;
+    else if(name ==xmlTagName(RoiRecord::ROI_POINT))  record.type =RoiRecord::ROI_POINT;
+    else  return false;
+    record.flags =reader.attributes().value("subPixel") ==QLatin1String("1") ? RoiRecord::FLAG_SUBPIXEL : 0;
+    while(reader.readNextStartElement()){
+        QStringRef field =reader.name();
+        double *dst =field ==QLatin1String("x") ? &record.x : field ==QLatin1String("y") ? &record.y
+                   : field ==QLatin1String("width") ? &record.width : field ==QLatin1String("height") ? &record.height
+                   : field ==QLatin1String("angle") ? &record.angle : field ==QLatin1String("shearAngle") ? &record.shearAngle
+                   : nullptr;
+        if(dst)  *dst =reader.readElementText(QXmlStreamReader::SkipChildElements).toDouble();
+        else  reader.skipCurrentElement();
+    }
+    return true;
+}
+
+/**
+ * @brief RoiRecipe::map  只读映射配方文件并校验文件头
+ * @param path
+ * @param error
+ * @return
+ */
+bool RoiRecipe::map(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly)){
+        setError(error, m_file.errorString());
+        return false;
+    }
+    qint64 size =m_file.size();
+    m_data =size >0 ? m_file.map(0, size) : nullptr;
+    int count =0;
+    if(!m_data || !checkHeader(m_data, size, count, error)){
+        if(!m_data)  setError(error, m_file.errorString());
+        close();
+        return false;
+    }
+    m_count =count;
+    m_records =reinterpret_cast<const RoiRecord*>(m_data +reinterpret_cast<const RoiRecipeHeader*>(m_data)->headerSize);
+    return true;
+}
+
+void RoiRecipe::close()
+{
+    if(m_data)  m_file.unmap(m_data);
+    m_file.close();
+    m_data =nullptr;
+    m_records =nullptr;
+    m_count =0;
+}
+
+bool RoiRecipe::checkHeader(const uchar *data, qint64 size, int &count, QString *error)
+{
+    if(size <qint64(sizeof(RoiRecipeHeader))){
+        setError(error, "RoiRecipe: file is too small");
+        return false;
+    }
+    RoiRecipeHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if(std::memcmp(header.magic, g_recipeMagic, sizeof(header.magic)) !=0){
+        setError(error, "RoiRecipe: not a recipe file");
+        return false;
+    }
+    if(header.byteOrder !=g_byteOrderMark){
+        setError(error, "RoiRecipe: byte order mismatch");
+        return false;
+    }
+    if(header.version >VERSION){
+        setError(error, QString("RoiRecipe: unsupported version %1").arg(header.version));
+        return false;
+    }
+    if(header.headerSize <sizeof(RoiRecipeHeader) || header.recordSize !=sizeof(RoiRecord)
+            || header.headerSize %alignof(RoiRecord) !=0){
+        setError(error, "RoiRecipe: unexpected header or record size");
+        return false;
+    }
+    if(size <qint64(header.headerSize) +qint64(header.count) *header.recordSize || header.count >quint32(INT_MAX)){
+        setError(error, "RoiRecipe: file is truncated");
+        return false;
+    }
+    count =int(header.count);
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef ROIRECIPE_H
+#define ROIRECIPE_H
+
+/**
+ROI配方的二进制存储，只依赖QtCore：文件头 +定长记录数组，可直接内存映射读取；
+同时提供旧版XML配方的流式导入
+**/
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+/**
+ * @brief The RoiRecord struct
+ * 一个ROI的定长记录(56字节)，字段含义由type决定：
+ * 矩形  x, y, width, height为左上角和宽高
+ * 卡尺  x, y为中心，width, height为上边长和左边长，angle, shearAngle为旋转角和倾斜角(弧度)
+ * 点    x, y为位置
+ */
+struct RoiRecord
+{
+    enum RoiType {ROI_RECT =1, ROI_CALIPER =2, ROI_POINT =3};
+    enum RoiFlag {FLAG_SUBPIXEL =0x1};
+
+    quint32 type;
+    quint32 flags;
+    double x;
+    double y;
+    double width;
+    double height;
+    double angle;
+    double shearAngle;
+
+    RoiRecord() :type(ROI_RECT), flags(0), x(0), y(0), width(0), height(0), angle(0), shearAngle(0)  {}
+};
+static_assert(sizeof(RoiRecord) ==56 && std::is_trivially_copyable<RoiRecord>::value,
+              "RoiRecord is the on-disk record layout");
+
+/**
+ * @brief The RoiRecipeHeader struct
+ * 文件头(32字节)。byteOrder按本机字节序写入0x01020304，读取时不一致则拒绝，
+ * 记录为本机字节序，映射后可直接使用
+ */
+struct RoiRecipeHeader
+{
+    char magic[8];
+    quint32 byteOrder;
+    quint16 version;
+    quint16 headerSize;
+    quint32 recordSize;
+    quint32 count;
+    quint64 reserved;
+};
+static_assert(sizeof(RoiRecipeHeader) ==32 && std::is_trivially_copyable<RoiRecipeHeader>::value,
+              "RoiRecipeHeader is the on-disk header layout");
+
+typedef std::function<bool(const RoiRecord&)> RoiRecordHandler;     //返回false中止读取
+typedef std::function<void(qint64 done, qint64 total)> RoiProgress;  //已读/总字节数
+
+/**
+ * @brief The RoiRecipe class
+ * 配方读写：save/load一次读写全部记录；map()只做内存映射和校验，记录直到close()前有效，
+ * 适合数万个ROI的配方按需访问而不复制。
+ * XML配方同样流式读写：readXml每读完一个ROI元素就交给handler，不在内存中构建整棵文档树
+ */
+class RoiRecipe
+{
+public:
+    enum {VERSION =1};
+
+    RoiRecipe();
+    ~RoiRecipe();
+
+    static bool save(const QString &path, const std::vector<RoiRecord> &records, QString *error =nullptr);
+    static bool load(const QString &path, std::vector<RoiRecord> &records, QString *error =nullptr);
+    static bool importXml(const QString &path, std::vector<RoiRecord> &records, QString *error =nullptr);
+    static bool saveXml(const QString &path, const std::vector<RoiRecord> &records, QString *error =nullptr);
+    static bool readXml(const QString &path, const RoiRecordHandler &handler,
+                        const RoiProgress &progress =RoiProgress(), QString *error =nullptr);
+    static void writeXmlRecord(QXmlStreamWriter &writer, const RoiRecord &record);
+    static bool readXmlRecord(QXmlStreamReader &reader, RoiRecord &record);
+
+    bool map(const QString &path, QString *error =nullptr);
+    void close();
+    int count() const  { return m_count;}
+    const RoiRecord* records() const  { return m_records;}
+    const RoiRecord& record(int index) const  { return m_records[index];}
+private:
+    QFile m_file;
+    uchar *m_data;
+    const RoiRecord *m_records;
+    int m_count;
+
+    static bool checkHeader(const uchar *data, qint64 size, int &count, QString *error);
+};
+
+#endif // ROIRECIPE_H
@@ -0,0 +1,260 @@
+#ifndef ROISHAPES_H
+#define ROISHAPES_H
+
+/**
+ROI几何值类型：矩形、卡尺(旋转/倾斜四边形)和点的变换、命中测试和配方记录转换。
+只依赖QtCore，不分配内存，不抛异常；交互图形只是这些值的视图，批处理可直接成批使用
+**/
+
+#include <cmath>
+#include "roigeometry.h"
+#include "roirecipe.h"
+
+/**
+ * @brief The RoiRectShape struct
+ * 轴对齐矩形ROI，rect为像素边界坐标
+ */
+struct RoiRectShape
+{
+    enum Region {OUTSIDE,
+                 INSIDE,
+                 TOP, RIGHT, BOTTOM, LEFT,
+                 TOPLEFT, TOPRIGHT,
+                 BOTTOMRIGHT, BOTTOMLEFT};
+    QRectF rect;
+
+    RoiRectShape() noexcept  {}
+    explicit RoiRectShape(const QRectF &r) noexcept :rect(r)  {}
+
+    /**
+     * @brief hitTest  判断pos位于矩形的哪个区域，角和边的判定带宽为tolerance
+     */
+    Region hitTest(const QPointF &pos, qreal tolerance) const noexcept
+    {
+        qreal px =pos.x(), py =pos.y();
+        int column, row;
+        if(std::abs(px -rect.left()) <=tolerance)  column =0;
+        else if(px >rect.left() +tolerance && px <rect.right() -tolerance)  column =1;
+        else if(std::abs(px -rect.right()) <=tolerance)  column =2;
+        else  return OUTSIDE;
+        if(std::abs(py -rect.top()) <=tolerance)  row =0;
+        else if(py >rect.top() +tolerance && py <rect.bottom() -tolerance)  row =1;
+        else if(std::abs(py -rect.bottom()) <=tolerance)  row =2;
+        else  return OUTSIDE;
+        static const Region regions[3][3] ={{TOPLEFT, TOP, TOPRIGHT},
+                                            {LEFT, INSIDE, RIGHT},
+                                            {BOTTOMLEFT, BOTTOM, BOTTOMRIGHT}};
+        return regions[row][column];
+    }
+
+    void translate(qreal dx, qreal dy) noexcept
+    {
+        rect.translate(dx, dy);
+    }
+
+    /**
+     * @brief dragHandle  把region对应的边或角拖到pos，对边不动，宽高不小于minLength
+     */
+    void dragHandle(Region region, const QPointF &pos, qreal minLength) noexcept
+    {
+        qreal x =pos.x(), y =pos.y();
+        bool left =region ==LEFT || region ==TOPLEFT || region ==BOTTOMLEFT;
+        bool right =region ==RIGHT || region ==TOPRIGHT || region ==BOTTOMRIGHT;
+        bool top =region ==TOP || region ==TOPLEFT || region ==TOPRIGHT;
+        bool bottom =region ==BOTTOM || region ==BOTTOMLEFT || region ==BOTTOMRIGHT;
+        if(left)  rect.setLeft(qMin(x, rect.right() -minLength));
+        if(right)  rect.setRight(qMax(x, rect.left() +minLength));
+        if(top)  rect.setTop(qMin(y, rect.bottom() -minLength));
+        if(bottom)  rect.setBottom(qMax(y, rect.top() +minLength));
+    }
+
+    RoiRecord toRecord() const noexcept
+    {
+        RoiRecord record;
+        record.type =RoiRecord::ROI_RECT;
+        record.x =rect.x();
+        record.y =rect.y();
+        record.width =rect.width();
+        record.height =rect.height();
+        return record;
+    }
+
+    static bool fromRecord(const RoiRecord &record, RoiRectShape &shape) noexcept
+    {
+        if(record.type !=RoiRecord::ROI_RECT)  return false;
+        shape.rect =QRectF(record.x, record.y, record.width, record.height);
+        return true;
+    }
+};
+
+/**
+ * @brief The RoiCaliperShape struct
+ * 卡尺ROI：以中心、上边长、左边长、旋转角和倾斜角表示，顶点 =中心 +旋转∘倾斜(±宽/2, ±高/2)。
+ * 区域编号：1~4为四角(左上起顺时针)，5、6为旋转和倾斜控制点(右边、下边中点)，7~10为四边(上边起顺时针)
+ */
+struct RoiCaliperShape
+{
+    enum Region {NONE,
+                 TOPLEFT, TOPRIGHT, BOTTOMRIGHT, BOTTOMLEFT,
+                 RIGHTMIDDLE, BOTTOMMIDDLE,
+                 TOP, RIGHT, BOTTOM, LEFT};
+    QPointF centre;
+    qreal width;
+    qreal height;
+    qreal angle;
+    qreal shearAngle;
+
+    RoiCaliperShape() noexcept :width(0), height(0), angle(0), shearAngle(0)  {}
+    RoiCaliperShape(const QPointF &c, qreal w, qreal h, qreal a, qreal s) noexcept
+        :centre(c), width(w), height(h), angle(a), shearAngle(s)  {}
+
+    void quad(RoiQuad &out) const noexcept
+    {
+        caliperQuad(centre, width, height, angle, shearAngle, out);
+    }
+
+    /**
+     * @brief hitTest  按已算好的顶点判断，优先级为旋转、倾斜控制点 >四角 >四边，全部用平方距离比较
+     */
+    static Region hitTest(const RoiQuad &quad, const QPointF &pos, qreal radius) noexcept
+    {
+        const qreal r2 =radius *radius;
+        if(roiSquaredDistance((quad[1] +quad[2]) /2, pos) <=r2)  return RIGHTMIDDLE;
+        if(roiSquaredDistance((quad[2] +quad[3]) /2, pos) <=r2)  return BOTTOMMIDDLE;
+        for(int i =0; i <4; i++){
+            if(roiSquaredDistance(pos, quad[i]) <=r2)
+                return Region(TOPLEFT +i);
+        }
+        for(int i =0; i <4; i++){
+            if(roiSquaredSegmentDistance(pos, quad[i], quad[i +1]) <=r2)
+                return Region(TOP +i);
+        }
+        return NONE;
+    }
+
+    Region hitTest(const QPointF &pos, qreal radius) const noexcept
+    {
+        RoiQuad q;
+        quad(q);
+        return hitTest(q, pos, radius);
+    }
+
+    void translate(const QPointF &delta) noexcept
+    {
+        centre +=delta;
+    }
+
+    /**
+     * @brief dragCorner
+     * 把第corner个角(0~3，左上起顺时针)拖向pos，对角顶点不动：在以中心为原点的轴对齐矩形空间中移动角点，
+     * 宽高分别不小于minWidth和minHeight，再由新矩形得到中心和边长。拖动量只去掉旋转，与倾斜无关
+     */
+    void dragCorner(int corner, const QPointF &pos, qreal minWidth, qreal minHeight) noexcept
+    {
+        if(corner <0 || corner >3)  return;
+        qreal sx =(corner ==1 || corner ==2) ? 1 : -1;
+        qreal sy =corner >=2 ? 1 : -1;
+        SinCos rot(angle);
+        RoiAffine toShape =RoiAffine::rotateShear(rot, SinCos(angle +shearAngle));
+        QPointF basePos(-sx *width /2, -sy *height /2);
+        QPointF cornerPos(sx *width /2, sy *height /2);
+        QPointF vertex =centre +toShape.map(cornerPos);
+        QPointF newPos =cornerPos +(rotatePoint(pos, vertex, rot.inverse()) -vertex);
+        if(sx *(newPos.x() -basePos.x()) <minWidth)
+            newPos.rx() =basePos.x() +sx *minWidth;
+        if(sy *(newPos.y() -basePos.y()) <minHeight)
+            newPos.ry() =basePos.y() +sy *minHeight;
+        centre +=toShape.map((newPos +basePos) /2);
+        width =sx *(newPos.x() -basePos.x());
+        height =sy *(newPos.y() -basePos.y());
+    }
+
+    /**
+     * @brief rotateTowards  绕中心转到pos方向
+     */
+    void rotateTowards(const QPointF &pos) noexcept
+    {
+        angle =std::atan2(pos.y() -centre.y(), pos.x() -centre.x());
+    }
+
+    /**
+     * @brief shearTowards
+     * 左右两边绕各自中点转向pos，中心和边长不变。左边在去掉旋转后的方向为(-sin(s), cos(s))，
+     * 高度与边长之比为cos(s)，cos(s)小于minCos时不改动
+     * @return  是否改动
+     */
+    bool shearTowards(const QPointF &pos, qreal minCos) noexcept
+    {
+        const qreal halfPi =1.57079632679489661923;
+        qreal nowAngle =std::atan2(pos.y() -centre.y(), pos.x() -centre.x()) -halfPi -angle;
+        if(std::cos(nowAngle) <minCos)  return false;
+        shearAngle =nowAngle;
+        return true;
+    }
+
+    /**
+     * @brief fromVertexes  由四个顶点(左上、右上、右下、左下)和角度得到参数
+     */
+    static RoiCaliperShape fromVertexes(const QPointF *v, qreal angle, qreal shearAngle) noexcept
+    {
+        return RoiCaliperShape(((v[0] +v[2]) /2 +(v[1] +v[3]) /2) /2, std::sqrt(roiSquaredDistance(v[0], v[1])),
+                               std::sqrt(roiSquaredDistance(v[0], v[3])), angle, shearAngle);
+    }
+
+    RoiRecord toRecord() const noexcept
+    {
+        RoiRecord record;
+        record.type =RoiRecord::ROI_CALIPER;
+        record.x =centre.x();
+        record.y =centre.y();
+        record.width =width;
+        record.height =height;
+        record.angle =angle;
+        record.shearAngle =shearAngle;
+        return record;
+    }
+
+    static bool fromRecord(const RoiRecord &record, RoiCaliperShape &shape) noexcept
+    {
+        if(record.type !=RoiRecord::ROI_CALIPER)  return false;
+        shape =RoiCaliperShape(QPointF(record.x, record.y), record.width, record.height, record.angle, record.shearAngle);
+        return true;
+    }
+};
+
+/**
+ * @brief The RoiPointShape struct  点ROI
+ */
+struct RoiPointShape
+{
+    QPointF pos;
+
+    RoiPointShape() noexcept  {}
+    explicit RoiPointShape(const QPointF &p) noexcept :pos(p)  {}
+
+    /**
+     * @brief hitTest  p是否在以pos为中心、半边长halfSize的方框内
+     */
+    bool hitTest(const QPointF &p, qreal halfSize) const noexcept
+    {
+        return std::abs(p.x() -pos.x()) <=halfSize && std::abs(p.y() -pos.y()) <=halfSize;
+    }
+
+    RoiRecord toRecord() const noexcept
+    {
+        RoiRecord record;
+        record.type =RoiRecord::ROI_POINT;
+        record.x =pos.x();
+        record.y =pos.y();
+        return record;
+    }
+
+    static bool fromRecord(const RoiRecord &record, RoiPointShape &shape) noexcept
+    {
+        if(record.type !=RoiRecord::ROI_POINT)  return false;
+        shape.pos =QPointF(record.x, record.y);
+        return true;
+    }
+};
+
+#endif // ROISHAPES_H
@@ -0,0 +1,124 @@
+#include "spatialgrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+//class SpatialGrid  均匀网格空间索引
+
+SpatialGrid::SpatialGrid(qreal cellSize) :m_cellSize(cellSize), m_stamp(0)
+{
+
+}
+
+SpatialGrid::~SpatialGrid()
+{
+
+}
+
+/**
+ * @brief SpatialGrid::setCellSize  修改格子大小会清空索引
+ * @param cellSize  一般取图形平均尺寸的1~2倍
+ */
+void SpatialGrid::setCellSize(qreal cellSize)
+{
+    m_cellSize =qMax(cellSize, qreal(1));
+    clear();
+}
+
+void SpatialGrid::clear()
+{
+    m_cells.clear();
+}
+
+void SpatialGrid::insert(int id, const QRectF &bounds)
+{
+    QRect range =cellRange(bounds);
+    for(int cy =range.top(); cy <=range.bottom(); ++cy){
+        for(int cx =range.left(); cx <=range.right(); ++cx){
+            m_cells[cellKey(cx, cy)].push_back(id);
+        }
+    }
+}
+
+/**
+ * @brief SpatialGrid::remove
+ * @param id
+ * @param bounds  必须与插入时的外接矩形一致
+ */
+void SpatialGrid::remove(int id, const QRectF &bounds)
+{
+    QRect range =cellRange(bounds);
+    for(int cy =range.top(); cy <=range.bottom(); ++cy){
+        for(int cx =range.left(); cx <=range.right(); ++cx){
+            auto it =m_cells.find(cellKey(cx, cy));
+            if(it ==m_cells.end())  continue;
+            std::vector<int> &cell =it.value();
+            auto pos =std::find(cell.begin(), cell.end(), id);
+            if(pos !=cell.end()){
+                *pos =cell.back();
+                cell.pop_back();
+            }
+            if(cell.empty())  m_cells.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief SpatialGrid::query
+ * 查询外接矩形可能与rect相交的id，每个id只出现一次，顺序不确定
+ * @param rect
+ * @param ids  输出，原有内容被清空
+ */
+void SpatialGrid::query(const QRectF &rect, std::vector<int> &ids) const
+{
+    ids.clear();
+    QRect range =cellRange(rect);
+    if(qint64(range.width()) *range.height() >m_cells.size()){
+        //查询范围比已占用的格子还多时直接遍历格子
+        for(auto it =m_cells.constBegin(); it !=m_cells.constEnd(); ++it){
+            int cx =int(qint32(it.key() &0xffffffff)), cy =int(qint32(it.key() >>32));
+            if(range.contains(cx, cy))  ids.insert(ids.end(), it.value().begin(), it.value().end());
+        }
+    }
+    else{
+        for(int cy =range.top(); cy <=range.bottom(); ++cy){
+            for(int cx =range.left(); cx <=range.right(); ++cx){
+                auto it =m_cells.constFind(cellKey(cx, cy));
+                if(it !=m_cells.constEnd())  ids.insert(ids.end(), it.value().begin(), it.value().end());
+            }
+        }
+    }
+    if(range.width() ==1 && range.height() ==1)  return;
+
+    //跨多个格子的图形会重复出现，用时间戳标记去重
+    if(++m_stamp ==0){
+        std::fill(m_marks.begin(), m_marks.end(), 0);
+        m_stamp =1;
+    }
+    size_t n =0;
+    for(size_t i =0; i <ids.size(); ++i){
+        int id =ids[i];
+        if(size_t(id) >=m_marks.size())  m_marks.resize(size_t(id) +1, 0);
+        if(m_marks[id] ==m_stamp)  continue;
+        m_marks[id] =m_stamp;
+        ids[n++] =id;
+    }
+    ids.resize(n);
+}
+
+void SpatialGrid::query(const QPointF &point, std::vector<int> &ids) const
+{
+    query(QRectF(point, QSizeF(0, 0)), ids);
+}
+
+QRect SpatialGrid::cellRange(const QRectF &rect) const
+{
+    int x0 =int(std::floor(rect.left() /m_cellSize)), y0 =int(std::floor(rect.top() /m_cellSize));
+    int x1 =int(std::floor(rect.right() /m_cellSize)), y1 =int(std::floor(rect.bottom() /m_cellSize));
+    return QRect(QPoint(x0, y0), QPoint(x1, y1));
+}
+
+quint64 SpatialGrid::cellKey(int cx, int cy)
+{
+    return (quint64(quint32(cy)) <<32) |quint64(quint32(cx));
+}
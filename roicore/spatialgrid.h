@@ -0,0 +1,36 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <QHash>
+#include <QRectF>
+#include <vector>
+
+/**
+ * @brief The SpatialGrid class
+ * 均匀网格空间索引：按外接矩形把id登记到覆盖的每个格子，查询只访问与查询范围相交的格子。
+ * 插入、删除为O(覆盖格子数)，适合大量尺寸相近、频繁移动的小图形
+ */
+class SpatialGrid
+{
+public:
+    SpatialGrid(qreal cellSize =64);
+    ~SpatialGrid();
+
+    void setCellSize(qreal cellSize);
+    qreal cellSize() const  { return m_cellSize;}
+    void clear();
+    void insert(int id, const QRectF &bounds);
+    void remove(int id, const QRectF &bounds);
+    void query(const QRectF &rect, std::vector<int> &ids) const;
+    void query(const QPointF &point, std::vector<int> &ids) const;
+private:
+    qreal m_cellSize;
+    QHash<quint64, std::vector<int> > m_cells;
+    mutable std::vector<quint32> m_marks;
+    mutable quint32 m_stamp;
+
+    QRect cellRange(const QRectF &rect) const;
+    static quint64 cellKey(int cx, int cy);
+};
+
+#endif // SPATIALGRID_H
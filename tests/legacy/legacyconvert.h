@@ -0,0 +1,49 @@
+#ifndef LEGACYCONVERT_H
+#define LEGACYCONVERT_H
+
+/**
+改用pixelconvert行内核之前的cvMat2QImage(8位单通道和三通道)，原样保留，
+作为bench/convert的比较基准
+**/
+
+#include <cstring>
+#include <QImage>
+#include <opencv2/core/core.hpp>
+
+namespace legacy {
+
+/**
+ * @brief cvMat2QImage  每次调用重建Indexed8调色板并逐行memcpy；三通道用rgbSwapped()交换通道。返回为深拷贝
+ */
+inline QImage cvMat2QImage(const cv::Mat &mat)
+{
+    if(mat.empty())  return QImage();
+    if(mat.type() == CV_8UC1)
+    {
+        QImage image(mat.cols, mat.rows, QImage::Format_Indexed8);
+        image.setColorCount(256);
+        for(int i = 0; i < 256; i++)
+        {
+            image.setColor(i, qRgb(i, i, i));
+        }
+        uchar *pSrc = mat.data;
+        for(int row = 0; row < mat.rows; row ++)
+        {
+            uchar *pDest = image.scanLine(row);
+            memcpy(pDest, pSrc, mat.cols);
+            pSrc += mat.step;
+        }
+        return image;
+    }
+    else if(mat.type() == CV_8UC3)
+    {
+        const uchar *pSrc = (const uchar*)mat.data;
+        QImage image(pSrc, mat.cols, mat.rows, mat.step, QImage::Format_RGB888);
+        return image.rgbSwapped();
+    }
+    return QImage();
+}
+
+} // namespace legacy
+
+#endif // LEGACYCONVERT_H
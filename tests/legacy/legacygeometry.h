@@ -0,0 +1,267 @@
+#ifndef LEGACYGEOMETRY_H
+#define LEGACYGEOMETRY_H
+
+/**
+改为闭式几何内核之前的ROI几何算法(多边形 +QTransform)，原样保留，
+作为tst_roigeometry的对照实现和bench/geometry的比较基准
+**/
+
+#include <cmath>
+#include <QPolygonF>
+#include <QRect>
+#include <QTransform>
+
+namespace legacy {
+
+const double Pi =3.14159265;
+const double g_minLen =20;
+const double g_minAngle =5;
+
+/**
+ * @brief getDistance  两点距离
+ */
+inline qreal getDistance(const QPointF &pt1, const QPointF &pt2)
+{
+    return sqrt(pow(pt2.x() -pt1.x(), 2) +pow(pt2.y() -pt1.y(), 2));
+}
+
+/**
+ * @brief getDistance  点到直线距离
+ */
+inline qreal getDistance(const QPointF &pt, const QPointF &A, const QPointF &B)
+{
+    if(A == B) return -1;
+    qreal mz =(pt.x() -A.x()) *(B.y() -A.y()) - (pt.y() -A.y()) *(B.x() -A.x());
+    mz *=mz;
+    qreal mm =pow(B.x() -A.x(), 2) +pow(B.y() -A.y(), 2);
+    return sqrt(mz /mm);
+}
+
+/**
+ * @brief getRotatedPoint  旋转某点
+ */
+inline QPointF getRotatedPoint(const QPointF &pt, const QPointF &center, qreal angle)
+{
+    QTransform translt1(1, 0, 0, 1, -center.x(), -center.y());
+    QTransform rotat(cos(angle), sin(angle), 0,
+                     -sin(angle), cos(angle), 0,
+                     0, 0, 1);
+    QTransform translt2(1, 0, 0, 1, center.x(),center.y());
+    translt1 *=rotat;
+    translt1 *=translt2;
+    return translt1.map(pt);
+}
+
+/**
+ * @brief getRotatedPolygon  旋转多边形
+ */
+inline QPolygonF getRotatedPolygon(const QPolygonF &poly, const QPointF &center, qreal angle)
+{
+    QPolygonF res;
+    for(int i =0; i <poly.size(); i++){
+        res.append(getRotatedPoint(poly[i], center, angle));
+    }
+    return res;
+}
+
+/**
+ * @brief getShearPolygon  倾斜多边形
+ */
+inline QPolygonF getShearPolygon(const QPolygonF &poly, qreal angle)
+{
+    QPolygonF res;
+    QPointF lmid =(poly[0] +poly[3]) /2;
+    QPointF rmid =(poly[1] +poly[2]) /2;
+    res <<getRotatedPoint(poly[0], lmid, angle)
+        <<getRotatedPoint(poly[1], rmid, angle)
+        <<getRotatedPoint(poly[2], rmid, angle)
+        <<getRotatedPoint(poly[3], lmid, angle)
+        <<getRotatedPoint(poly[0], lmid, angle);
+    return res;
+}
+
+/**
+ * @brief getMovedPolygon  移动多边形
+ */
+inline QPolygonF getMovedPolygon(const QPolygonF &poly, qreal dx, qreal dy)
+{
+    QTransform translt(1, 0, 0, 1, dx, dy);
+    return translt.map(poly);
+}
+
+/**
+ * @brief rectRegion  SimpleROI::judgePosition(整数矩形)，区域编号与RoiRectShape::Region一致
+ */
+inline int rectRegion(const QRect &m_rect, const QPointF &pos, int delta)
+{
+    enum {OUTSIDE, INSIDE, TOP, RIGHT, BOTTOM, LEFT, TOPLEFT, TOPRIGHT, BOTTOMRIGHT, BOTTOMLEFT};
+    qreal px =pos.x(), py =pos.y();
+    if(std::abs(px -m_rect.x()) <=delta){
+        if(std::abs(py -m_rect.y()) <=delta)
+            return TOPLEFT;
+        else if(py >m_rect.y() +delta && py <m_rect.bottom() +1 -delta)
+            return LEFT;
+        else if(std::abs(py -m_rect.bottom() -1) <=delta)
+            return BOTTOMLEFT;
+        else
+            return OUTSIDE;
+    }
+    else if(px >m_rect.x() +delta && px <m_rect.right() +1 -delta){
+        if(std::abs(py -m_rect.y()) <=delta)
+            return TOP;
+        else if(py >m_rect.y() +delta && py <m_rect.bottom() +1 -delta)
+            return INSIDE;
+        else if(std::abs(py -m_rect.bottom() -1) <=delta)
+            return BOTTOM;
+        else
+            return OUTSIDE;
+    }
+    else if(std::abs(px -m_rect.right() -1) <=delta){
+        if(std::abs(py -m_rect.y()) <=delta)
+            return TOPRIGHT;
+        else if(py >m_rect.y() +delta && py <m_rect.bottom() +1 -delta)
+            return RIGHT;
+        else if(std::abs(py -m_rect.bottom() -1) <=delta)
+            return BOTTOMRIGHT;
+        else
+            return OUTSIDE;
+    }
+    else
+        return OUTSIDE;
+}
+
+/**
+ * @brief The Caliper class
+ * CaliperTool以闭合多边形保存几何时的变换，区域编号与RoiCaliperShape::Region一致
+ */
+class Caliper
+{
+public:
+    QPolygonF m_mainShape;
+    qreal m_angle;
+    qreal m_shearAngle;
+
+    Caliper() :m_angle(0), m_shearAngle(0)  {}
+
+    QPointF centre() const
+    {
+        QPointF c1 =(m_mainShape[0] +m_mainShape[2]) /2;
+        QPointF c2 =(m_mainShape[1] +m_mainShape[3]) /2;
+        return (c1 +c2) /2;
+    }
+
+    int judgePosition(const QPointF &pos, qreal size) const
+    {
+        QPointF rmid =(m_mainShape[1] +m_mainShape[2]) /2;
+        if(getDistance(rmid, pos) <=size)  return 5;
+
+        QPointF bmid =(m_mainShape[2] +m_mainShape[3]) /2;
+        if(getDistance(bmid, pos) <=size)  return 6;
+
+        for(int i =0; i <4; i++){
+            qreal dist =getDistance(pos, m_mainShape[i]);
+            if(dist <=size)
+                return 1 +i;
+        }
+
+        for(int i =0; i <4; i++){
+            qreal dist =getDistance(pos, m_mainShape[i], m_mainShape[i +1]);
+            if(dist <=size)
+                return 7 +i;
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief scale  拖动第region个角(1~4，左上起顺时针)
+     */
+    void scale(int region, const QPointF &pos)
+    {
+        QPolygonF tempPoly0 =getRotatedPolygon(m_mainShape, centre(), -m_angle);
+        QPolygonF tempPoly =getShearPolygon(tempPoly0, -m_shearAngle);
+        QPointF pos1 =getRotatedPoint(pos, centre(), -m_angle);
+        QPointF newPos, basePos;
+        int regress =0;
+        if(region ==1){
+            newPos =tempPoly[0] +pos1 -tempPoly0[0];
+            basePos =tempPoly[2];
+            if(basePos.x() -newPos.x() <g_minLen)
+                newPos.rx() =basePos.x() -g_minLen;
+            if(basePos.y() -newPos.y() <g_minLen /2)
+                newPos.ry() =basePos.y() -g_minLen /2;
+            tempPoly[0] =newPos;
+            tempPoly[1].ry() =newPos.y();
+            tempPoly[3].rx() =newPos.x();
+            regress =2;
+        }
+        else if(region ==2){
+            newPos =tempPoly[1] +pos1 -tempPoly0[1];
+            basePos =tempPoly[3];
+            if(newPos.x() -basePos.x() <g_minLen)
+                newPos.rx() =basePos.x() +g_minLen;
+            if(basePos.y() -newPos.y() <g_minLen /2)
+                newPos.ry() =basePos.y() -g_minLen /2;
+            tempPoly[1] =newPos;
+            tempPoly[2].rx() =newPos.x();
+            tempPoly[0].ry() =newPos.y();
+            regress =3;
+        }
+        else if(region ==3){
+            newPos =tempPoly[2] +pos1 -tempPoly0[2];
+            basePos =tempPoly[0];
+            if(newPos.x() -basePos.x() <g_minLen)
+                newPos.rx() =basePos.x() +g_minLen;
+            if(newPos.y() -basePos.y() <g_minLen /2)
+                newPos.ry() =basePos.y() +g_minLen /2;
+            tempPoly[2] =newPos;
+            tempPoly[3].ry() =newPos.y();
+            tempPoly[1].rx() =newPos.x();
+            regress =0;
+        }
+        else if(region ==4){
+            newPos =tempPoly[3] +pos1 -tempPoly0[3];
+            basePos =tempPoly[1];
+            if(basePos.x() -newPos.x() <g_minLen)
+                newPos.rx() =basePos.x() -g_minLen;
+            if(newPos.y() -basePos.y() <g_minLen /2)
+                newPos.ry() =basePos.y() +g_minLen /2;
+            tempPoly[3] =newPos;
+            tempPoly[0].rx() =newPos.x();
+            tempPoly[2].ry() =newPos.y();
+            regress =1;
+        }
+        tempPoly[4] =tempPoly[0];
+        tempPoly =getShearPolygon(tempPoly, m_shearAngle);
+        tempPoly =getRotatedPolygon(tempPoly, centre(), m_angle);
+        QPointF delta =m_mainShape[regress] -tempPoly[regress];
+        m_mainShape =getMovedPolygon(tempPoly, delta.x(), delta.y());
+    }
+
+    void rotate(const QPointF &pos)
+    {
+        qreal oldAngle =m_angle;
+        m_angle =atan2(pos.y() -centre().y(), pos.x() -centre().x());
+        qreal delta =m_angle -oldAngle;
+        m_mainShape =getRotatedPolygon(m_mainShape, centre(), delta);
+    }
+
+    void shear(const QPointF &pos)
+    {
+        qreal nowAngle =atan2(pos.y() -centre().y(), pos.x() -centre().x()) -Pi /2 -m_angle;
+        qreal delta =nowAngle -m_shearAngle;
+        QPolygonF tempPoly =getShearPolygon(m_mainShape, delta);
+        qreal height =getDistance(tempPoly[0], tempPoly[2], tempPoly[3]);
+        qreal length =getDistance(tempPoly[0], tempPoly[3]);
+        QPointF p0 =getRotatedPoint(tempPoly[0], centre(), -m_angle);
+        QPointF p1 =getRotatedPoint(tempPoly[3], centre(), -m_angle);
+        if(p0.y() <=p1.y() && height >=length *sin(g_minAngle *Pi /180)){
+            m_mainShape =getShearPolygon(m_mainShape, delta);
+            m_shearAngle =nowAngle;
+        }
+    }
+};
+
+} // namespace legacy
+
+#endif // LEGACYGEOMETRY_H
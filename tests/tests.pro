@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+# 正确性测试(QtTest)，make check运行
+# tst_spatialgrid: 网格索引与逐个比较的结果一致
+# tst_roigeometry: roicore几何内核与原多边形算法(legacy/legacygeometry.h)一致
+SUBDIRS += \
+    tst_spatialgrid \
+    tst_roigeometry
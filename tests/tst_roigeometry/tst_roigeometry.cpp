@@ -0,0 +1,196 @@
+#include <QtTest>
+#include <random>
+#include "roishapes.h"
+#include "legacygeometry.h"
+
+/**
+roicore几何内核与原多边形算法(legacygeometry.h)对照：矩形和卡尺的命中区域、卡尺的缩放、旋转、倾斜。
+变换每一步之后比较顶点，再把原算法的多边形同步为新结果，避免误差逐步放大掩盖单步差异
+**/
+
+#define GEOMETRY_STEPS 20000
+#define GEOMETRY_TOLERANCE 1e-6
+#define HIT_SIZE 5
+
+class TestRoiGeometry :public QObject
+{
+    Q_OBJECT
+private slots:
+    void rectHitTest();
+    void caliperHitTest();
+    void caliperScale();
+    void caliperRotate();
+    void caliperShear();
+    void caliperRecord();
+private:
+    static void toLegacy(const RoiCaliperShape &shape, legacy::Caliper &caliper);
+    static qreal quadError(const legacy::Caliper &caliper, const RoiCaliperShape &shape);
+    static RoiCaliperShape randomShape(std::mt19937 &rng);
+};
+
+void TestRoiGeometry::toLegacy(const RoiCaliperShape &shape, legacy::Caliper &caliper)
+{
+    RoiQuad quad;
+    shape.quad(quad);
+    caliper.m_mainShape =QPolygonF();
+    for(int i =0; i <5; i++)
+        caliper.m_mainShape <<quad[i];
+    caliper.m_angle =shape.angle;
+    caliper.m_shearAngle =shape.shearAngle;
+}
+
+qreal TestRoiGeometry::quadError(const legacy::Caliper &caliper, const RoiCaliperShape &shape)
+{
+    RoiQuad quad;
+    shape.quad(quad);
+    qreal error =0;
+    for(int i =0; i <5; i++){
+        error =qMax(error, std::abs(caliper.m_mainShape[i].x() -quad[i].x()));
+        error =qMax(error, std::abs(caliper.m_mainShape[i].y() -quad[i].y()));
+    }
+    return error;
+}
+
+RoiCaliperShape TestRoiGeometry::randomShape(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<qreal> pos(-500, 500), width(20, 300), height(10, 120), angle(-3, 3), shear(-1.2, 1.2);
+    return RoiCaliperShape(QPointF(pos(rng), pos(rng)), width(rng), height(rng), angle(rng), shear(rng));
+}
+
+/**
+ * @brief TestRoiGeometry::rectHitTest  整数矩形上与原judgePosition逐点一致，含整数坐标的边界点和带宽重叠的小矩形
+ */
+void TestRoiGeometry::rectHitTest()
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> origin(-50, 50), size(1, 60);
+    std::uniform_real_distribution<qreal> offset(-10, 70);
+    for(int i =0; i <GEOMETRY_STEPS; i++){
+        QRect rect(origin(rng), origin(rng), size(rng), size(rng));
+        QPointF pos(rect.x() +offset(rng), rect.y() +offset(rng));
+        if(i %2)  pos =QPointF(qRound(pos.x()), qRound(pos.y()));
+        int expected =legacy::rectRegion(rect, pos, HIT_SIZE);
+        int actual =RoiRectShape(QRectF(rect)).hitTest(pos, HIT_SIZE);
+        if(actual !=expected)
+            QFAIL(qPrintable(QString("rect (%1,%2 %3x%4) at (%5,%6): %7, expected %8").arg(rect.x()).arg(rect.y())
+                             .arg(rect.width()).arg(rect.height()).arg(pos.x()).arg(pos.y()).arg(actual).arg(expected)));
+    }
+}
+
+/**
+ * @brief TestRoiGeometry::caliperHitTest
+ * 原算法按点到直线的距离判断边，线段延长线上的点也算命中；新内核按点到线段的距离，这类点不比较
+ */
+void TestRoiGeometry::caliperHitTest()
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<qreal> jitter(-12, 12), unit(0, 1);
+    int compared =0;
+    for(int i =0; i <GEOMETRY_STEPS; i++){
+        RoiCaliperShape shape =randomShape(rng);
+        legacy::Caliper caliper;
+        toLegacy(shape, caliper);
+        RoiQuad quad;
+        shape.quad(quad);
+        int edge =int(rng() %4);
+        QPointF pos =quad[edge] +(quad[edge +1] -quad[edge]) *unit(rng) *(i %3 ? 1 : 0) +QPointF(jitter(rng), jitter(rng));
+
+        int expected =caliper.judgePosition(pos, HIT_SIZE);
+        if(expected >=RoiCaliperShape::TOP){
+            const QPointF &a =quad[expected -RoiCaliperShape::TOP], &b =quad[expected -RoiCaliperShape::TOP +1];
+            qreal t =QPointF::dotProduct(pos -a, b -a) /QPointF::dotProduct(b -a, b -a);
+            if(t <0 || t >1)  continue;
+        }
+        compared++;
+        QCOMPARE(int(RoiCaliperShape::hitTest(quad, pos, HIT_SIZE)), expected);
+    }
+    QVERIFY(compared >GEOMETRY_STEPS *3 /4);
+}
+
+void TestRoiGeometry::caliperScale()
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<qreal> drag(-80, 80);
+    RoiCaliperShape shape =randomShape(rng);
+    legacy::Caliper caliper;
+    for(int i =0; i <GEOMETRY_STEPS; i++){
+        if(i %500 ==0)  shape =randomShape(rng);
+        toLegacy(shape, caliper);
+        int corner =int(rng() %4);
+        RoiQuad quad;
+        shape.quad(quad);
+        QPointF pos =quad[corner] +QPointF(drag(rng), drag(rng));
+        caliper.scale(corner +1, pos);
+        shape.dragCorner(corner, pos, legacy::g_minLen, legacy::g_minLen /2);
+        qreal error =quadError(caliper, shape);
+        if(error >GEOMETRY_TOLERANCE)
+            QFAIL(qPrintable(QString("step %1 corner %2: error %3").arg(i).arg(corner).arg(error)));
+    }
+}
+
+void TestRoiGeometry::caliperRotate()
+{
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<qreal> around(-200, 200);
+    RoiCaliperShape shape =randomShape(rng);
+    legacy::Caliper caliper;
+    for(int i =0; i <GEOMETRY_STEPS; i++){
+        if(i %500 ==0)  shape =randomShape(rng);
+        toLegacy(shape, caliper);
+        QPointF pos =shape.centre +QPointF(around(rng), around(rng));
+        caliper.rotate(pos);
+        shape.rotateTowards(pos);
+        QVERIFY(std::abs(caliper.m_angle -shape.angle) <1e-12);
+        qreal error =quadError(caliper, shape);
+        if(error >GEOMETRY_TOLERANCE)
+            QFAIL(qPrintable(QString("step %1: error %2").arg(i).arg(error)));
+    }
+}
+
+/**
+ * @brief TestRoiGeometry::caliperShear  包括超过最小角度被拒绝的情况，两者须同时接受或拒绝
+ */
+void TestRoiGeometry::caliperShear()
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<qreal> around(-200, 200);
+    const qreal minCos =std::sin(legacy::g_minAngle *legacy::Pi /180);
+    RoiCaliperShape shape =randomShape(rng);
+    legacy::Caliper caliper;
+    int accepted =0, rejected =0;
+    for(int i =0; i <GEOMETRY_STEPS; i++){
+        if(i %500 ==0)  shape =randomShape(rng);
+        toLegacy(shape, caliper);
+        QPointF pos =shape.centre +QPointF(around(rng), around(rng));
+        qreal oldShear =caliper.m_shearAngle;
+        caliper.shear(pos);
+        bool changed =shape.shearTowards(pos, minCos);
+        QCOMPARE(changed, caliper.m_shearAngle !=oldShear);
+        (changed ? accepted : rejected)++;
+        QVERIFY(std::abs(caliper.m_shearAngle -shape.shearAngle) <1e-8);
+        qreal error =quadError(caliper, shape);
+        if(error >GEOMETRY_TOLERANCE)
+            QFAIL(qPrintable(QString("step %1: error %2").arg(i).arg(error)));
+    }
+    QVERIFY(accepted >0 && rejected >0);
+}
+
+void TestRoiGeometry::caliperRecord()
+{
+    std::mt19937 rng(6);
+    for(int i =0; i <100; i++){
+        RoiCaliperShape shape =randomShape(rng), restored;
+        QVERIFY(RoiCaliperShape::fromRecord(shape.toRecord(), restored));
+        QCOMPARE(restored.centre, shape.centre);
+        QCOMPARE(restored.width, shape.width);
+        QCOMPARE(restored.height, shape.height);
+        QCOMPARE(restored.angle, shape.angle);
+        QCOMPARE(restored.shearAngle, shape.shearAngle);
+    }
+    RoiCaliperShape unchanged;
+    QVERIFY(!RoiCaliperShape::fromRecord(RoiRectShape(QRectF(0, 0, 10, 10)).toRecord(), unchanged));
+}
+
+QTEST_APPLESS_MAIN(TestRoiGeometry)
+
+#include "tst_roigeometry.moc"
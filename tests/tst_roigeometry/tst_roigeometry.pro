@@ -0,0 +1,18 @@
+QT       += testlib
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_roigeometry
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../legacy
+
+SOURCES += \
+    tst_roigeometry.cpp
+
+HEADERS += \
+    ../legacy/legacygeometry.h
+
+include(../../roicore/roicore.pri)
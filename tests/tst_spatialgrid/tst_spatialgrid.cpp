@@ -0,0 +1,141 @@
+#include <QtTest>
+#include <random>
+#include <set>
+#include "spatialgrid.h"
+
+/**
+SpatialGrid与逐个比较的结果对照：查询结果不能漏掉任何外接矩形与查询范围相交的id，
+不能重复，不能含已删除的id；图形移动(删除后按新位置插入)后仍然成立
+**/
+
+#define GRID_ITEMS 3000
+#define GRID_QUERIES 1000
+
+class TestSpatialGrid :public QObject
+{
+    Q_OBJECT
+private slots:
+    void queryRect_data();
+    void queryRect();
+    void queryPoint();
+    void removeAll();
+    void setCellSizeClears();
+private:
+    std::vector<QRectF> m_bounds;
+    std::vector<bool> m_live;
+
+    void populate(SpatialGrid &grid, std::mt19937 &rng);
+    void checkQuery(const SpatialGrid &grid, const QRectF &rect);
+    static bool intersects(const QRectF &a, const QRectF &b);
+};
+
+bool TestSpatialGrid::intersects(const QRectF &a, const QRectF &b)
+{
+    return a.left() <=b.right() && b.left() <=a.right() && a.top() <=b.bottom() && b.top() <=a.bottom();
+}
+
+/**
+ * @brief TestSpatialGrid::populate  插入随机矩形(含负坐标和跨多个格子的大矩形)，移动其中一半，删除十分之一
+ */
+void TestSpatialGrid::populate(SpatialGrid &grid, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<qreal> pos(-2000, 2000), size(0, 150), big(0, 1200), shift(-40, 40);
+    m_bounds.resize(GRID_ITEMS);
+    m_live.assign(GRID_ITEMS, true);
+    for(int i =0; i <GRID_ITEMS; i++){
+        qreal w =i %50 ==0 ? big(rng) : size(rng), h =i %50 ==0 ? big(rng) : size(rng);
+        m_bounds[i] =QRectF(pos(rng), pos(rng), w, h);
+        grid.insert(i, m_bounds[i]);
+    }
+    for(int i =0; i <GRID_ITEMS; i +=2){
+        grid.remove(i, m_bounds[i]);
+        m_bounds[i].translate(shift(rng), shift(rng));
+        grid.insert(i, m_bounds[i]);
+    }
+    for(int i =0; i <GRID_ITEMS; i +=10){
+        grid.remove(i, m_bounds[i]);
+        m_live[i] =false;
+    }
+}
+
+void TestSpatialGrid::checkQuery(const SpatialGrid &grid, const QRectF &rect)
+{
+    std::vector<int> ids;
+    grid.query(rect, ids);
+    std::set<int> found(ids.begin(), ids.end());
+    QCOMPARE(found.size(), ids.size());
+    for(int id : ids){
+        QVERIFY(id >=0 && id <GRID_ITEMS);
+        QVERIFY2(m_live[id], qPrintable(QString("removed id %1 returned").arg(id)));
+    }
+    for(int i =0; i <GRID_ITEMS; i++){
+        if(m_live[i] && intersects(m_bounds[i], rect))
+            QVERIFY2(found.count(i), qPrintable(QString("id %1 missing").arg(i)));
+    }
+}
+
+void TestSpatialGrid::queryRect_data()
+{
+    QTest::addColumn<qreal>("cellSize");
+    QTest::newRow("fine") <<qreal(16);
+    QTest::newRow("typical") <<qreal(64);
+    QTest::newRow("coarse") <<qreal(500);
+}
+
+void TestSpatialGrid::queryRect()
+{
+    QFETCH(qreal, cellSize);
+    SpatialGrid grid(cellSize);
+    std::mt19937 rng(1);
+    populate(grid, rng);
+    //小范围走逐格查找，大范围走遍历已占用格子
+    std::uniform_real_distribution<qreal> pos(-2200, 2200), small(0, 60), large(0, 3000);
+    for(int q =0; q <GRID_QUERIES; q++){
+        qreal w =q %2 ? large(rng) : small(rng), h =q %2 ? large(rng) : small(rng);
+        checkQuery(grid, QRectF(pos(rng), pos(rng), w, h));
+        if(QTest::currentTestFailed())  return;
+    }
+}
+
+void TestSpatialGrid::queryPoint()
+{
+    SpatialGrid grid(64);
+    std::mt19937 rng(2);
+    populate(grid, rng);
+    std::uniform_real_distribution<qreal> pos(-2200, 2200);
+    for(int q =0; q <GRID_QUERIES; q++){
+        checkQuery(grid, QRectF(QPointF(pos(rng), pos(rng)), QSizeF(0, 0)));
+        if(QTest::currentTestFailed())  return;
+    }
+    //正好落在格子边界上
+    checkQuery(grid, QRectF(QPointF(0, 0), QSizeF(0, 0)));
+    checkQuery(grid, QRectF(QPointF(-64, 128), QSizeF(0, 0)));
+}
+
+void TestSpatialGrid::removeAll()
+{
+    SpatialGrid grid(64);
+    std::mt19937 rng(3);
+    populate(grid, rng);
+    for(int i =0; i <GRID_ITEMS; i++){
+        if(m_live[i])  grid.remove(i, m_bounds[i]);
+    }
+    std::vector<int> ids;
+    grid.query(QRectF(-5000, -5000, 10000, 10000), ids);
+    QVERIFY(ids.empty());
+}
+
+void TestSpatialGrid::setCellSizeClears()
+{
+    SpatialGrid grid(64);
+    grid.insert(7, QRectF(10, 10, 20, 20));
+    grid.setCellSize(32);
+    QCOMPARE(grid.cellSize(), qreal(32));
+    std::vector<int> ids;
+    grid.query(QRectF(0, 0, 100, 100), ids);
+    QVERIFY(ids.empty());
+}
+
+QTEST_APPLESS_MAIN(TestSpatialGrid)
+
+#include "tst_spatialgrid.moc"
@@ -0,0 +1,14 @@
+QT       += testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_spatialgrid
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    tst_spatialgrid.cpp
+
+include(../../roicore/roicore.pri)